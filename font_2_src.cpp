@@ -5,6 +5,8 @@
 #include <vector>
 #include <map>
 #include <algorithm>
+#include <queue>
+#include <unordered_map>
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -16,6 +18,7 @@
 #include <libgen.h>
 
 #include "font_bmp.h"
+#include "font_bmp_file.h"
 
 
 // font symbol description
@@ -28,6 +31,7 @@ struct source_symbol_desc_s{
   int m_x_offset;    // x offset for display symbol
   int m_y_offset;    // y offset for display symbol
   int m_x_advance;   // displayed width of symbol
+  int m_page;        // page id of font bitmap
   void fill_packed( packed_symbol_desc_s & a_dst, int a_offset, bool a_nibble ) const {
     a_dst.m_code = m_code;
     a_dst.m_offset = a_offset;
@@ -41,18 +45,29 @@ struct source_symbol_desc_s{
 };
 
 
+// font page image, loaded one at a time
+struct source_page_s {
+  std::vector<uint8_t> m_bmp;   // brightness of pixels, one byte per pixel
+  int m_width;                  // page width in pixels
+  int m_height;                 // page height in pixels
+  source_page_s()
+    : m_width(0)
+    , m_height(0)
+    {}
+};
+
+
 // source font desription
 struct source_font_desc_s {
-  std::vector<uint8_t> m_bmp;   // font image
   int m_bmp_width;              // font symbols bmp width
   int m_bmp_height;             // font symbols bmp height
   int m_symbols_count;          // total symbols
   int m_row_height;             // text row height
   int m_def_code_idx;           // default symbol index, if symbol code not found
-  int m_tga_line_bytes;         // bytes in one tga line
-  int m_tga_pixel_bytes;        // bytes in one tga pixel (usually 3 or 4)
   const char * m_header_file_name; // font header file name
+  std::string m_desc_dir;       // directory of font description, for relative pages file names
   std::string m_face;           // font face name, using as alias name
+  std::vector<std::string> m_pages; // pages images file names by page id
   std::vector<source_symbol_desc_s> m_symbols; // descriptions of symbols ptr
   int m_max_symbol_width;       // in pixels
   source_font_desc_s()
@@ -61,14 +76,52 @@ struct source_font_desc_s {
     , m_symbols_count(0)
     , m_row_height(0)
     , m_def_code_idx(0)
-    , m_tga_line_bytes(0)
-    , m_tga_pixel_bytes(0)
     , m_header_file_name(0)
     , m_max_symbol_width(0)
     {}
 };
 
 
+// max brightness beyond shade interval, pixel may take only neighbour shades
+#define SHADE_TOLERANCE_MAX 31
+
+
+// conversion options
+struct convert_options_s {
+  bool m_rows_index;            // write rows index for random access to symbol rows
+  bool m_lookup_tables;         // write direct table and codes ranges for fast symbol lookup
+  bool m_huffman;               // write huffman coded packed data, if it is smaller than nibbles
+  bool m_compact_symbols;       // write compact symbols table instead of packed_symbol_desc_s array
+  const char * m_binary_file_name; // write binary font file too, if set
+  int m_shade_tolerance;        // brightness beyond shade interval, pixel may take neighbour shade within it
+  const char * m_constexpr_file_name; // write constexpr C++ metrics header too, if set
+  convert_options_s()
+    : m_rows_index(false)
+    , m_lookup_tables(false)
+    , m_huffman(false)
+    , m_compact_symbols(false)
+    , m_binary_file_name(0)
+    , m_shade_tolerance(0)
+    , m_constexpr_file_name(0)
+    {}
+};
+
+
+// font tables for binary font file, sections as they are in memory
+struct binary_font_s {
+  std::vector<uint8_t> m_sections[FONT_FILE_SECTIONS];
+  int m_pos_bytes;              // bytes of position in compact symbols table
+  binary_font_s()
+    : m_pos_bytes(0)
+    {}
+  template<typename T>
+  void set( int a_section, const std::vector<T> & a_src ) {
+    const uint8_t * v_begin = reinterpret_cast<const uint8_t *>( a_src.data() );
+    m_sections[a_section].assign( v_begin, v_begin + a_src.size() * sizeof(T) );
+  }
+};
+
+
 #pragma pack(push,1)
 struct targaheader_s
 {
@@ -109,10 +162,10 @@ bool compare_two_source_symbol_desc_s( const source_symbol_desc_s & a1, const so
 std::string g_line_cache;
 // key-value pairs for current line
 std::map<const char *, const char *, compare_two_char_ptr> g_line_parts;
-// load font description from text file and bmp data from targa image file
+// load font description from text file
 bool load_font_desc( FILE * a_fp, source_font_desc_s & a_dst );
-// write out .h and .c files with packed font
-void write_packed_font( FILE * a_out_h, FILE * a_out_c, const source_font_desc_s & a_src );
+// write out .h and .c files with packed font, pages images are loaded and packed one by one
+bool write_packed_font( FILE * a_out_h, FILE * a_out_c, const source_font_desc_s & a_src, const convert_options_s & a_options );
 // parse params line
 bool parse_line( char * a_src );
 // get string value
@@ -123,8 +176,48 @@ bool get_value( char * a_src, const char * a_name, int & a_dst );
 
 // entry point
 int main( int argc, char ** argv ) {
+  convert_options_s v_options;
+  int v_opt;
+  while ( -1 != (v_opt = ::getopt( argc, argv, "rlHcb:e:x:" )) ) {
+    switch ( v_opt ) {
+      case 'r':
+        v_options.m_rows_index = true;
+        break;
+      case 'l':
+        v_options.m_lookup_tables = true;
+        break;
+      case 'H':
+        v_options.m_huffman = true;
+        break;
+      case 'c':
+        v_options.m_compact_symbols = true;
+        break;
+      case 'b':
+        v_options.m_binary_file_name = optarg;
+        break;
+      case 'e':
+        v_options.m_shade_tolerance = std::max( 0, std::min( SHADE_TOLERANCE_MAX, ::atoi( optarg ) ) );
+        break;
+      case 'x':
+        v_options.m_constexpr_file_name = optarg;
+        break;
+      default:
+        return 1;
+    }
+  }
+  argc -= optind - 1;
+  argv += optind - 1;
   if ( 4 != argc ) {
-    ::fprintf( stderr, "need a input.txt and output.h with output.c(pp) file names\n" );
+    ::fprintf( stderr, "need a input.txt and output.h with output.c(pp) file names\n"
+                       "options:\n"
+                       "  -r  write rows index for random access to symbol rows\n"
+                       "  -l  write lookup tables for constant time symbol search\n"
+                       "  -H  write huffman coded packed data, if it is smaller\n"
+                       "  -c  write compact symbols table, codes apart from metrics\n"
+                       "  -b file  write binary font file for font_file_open() too\n"
+                       "  -e N  pixels within N brightness levels of neighbour shade may take it,\n"
+                       "        if packed data gets smaller (0..31, default 0 - lossless)\n"
+                       "  -x file  write constexpr C++ metrics header for compile time measurement too\n" );
     return 1;
   }
 
@@ -149,6 +242,10 @@ int main( int argc, char ** argv ) {
 
   source_font_desc_s v_font_desc;
   v_font_desc.m_header_file_name = argv[2];
+  const char * v_desc_dir_end = ::strrchr( argv[1], '/' );
+  if ( v_desc_dir_end ) {
+    v_font_desc.m_desc_dir.assign( argv[1], v_desc_dir_end - argv[1] + 1 );
+  }
   if ( !load_font_desc(v_fp_in.get(), v_font_desc) ) {
     ::fprintf( stderr, "error loading font description from file '%s'\n", argv[1] );
     return 1;
@@ -157,12 +254,15 @@ int main( int argc, char ** argv ) {
   std::make_heap( v_font_desc.m_symbols.begin(), v_font_desc.m_symbols.end(), compare_two_source_symbol_desc_s );
   std::sort_heap( v_font_desc.m_symbols.begin(), v_font_desc.m_symbols.end(), compare_two_source_symbol_desc_s );
 
-  write_packed_font( v_fp_out_h.get(), v_fp_out_c.get(), v_font_desc );
+  if ( !write_packed_font( v_fp_out_h.get(), v_fp_out_c.get(), v_font_desc, v_options ) ) {
+    return 1;
+  }
   return 0;
 }
 
 
-bool load_tga_file( const char * a_file_name, source_font_desc_s & a_dst );
+// load page image, PNG or targa
+bool load_page_file( const char * a_file_name, source_page_s & a_dst );
 
 
 #define LN_START_INFO     "info "
@@ -177,6 +277,8 @@ bool load_tga_file( const char * a_file_name, source_font_desc_s & a_dst );
 #define RD_ST_CHARS   (1 << 3)
 #define RD_ST_ALL     (RD_ST_INFO|RD_ST_COMMON|RD_ST_PAGE|RD_ST_CHARS)
 
+#define MAX_PAGES_COUNT   256
+
 
 void replace_extra_symbols( std::string & a_str ) {
   // replace symbols
@@ -229,16 +331,27 @@ bool load_font_desc( FILE * a_fp, source_font_desc_s & a_dst ) {
       continue;
     }
     if ( 0 == ::strncmp( v_line, LN_START_PAGE, ::strlen(LN_START_PAGE) ) ) {
-      if ( 0 != (v_info_read_state & RD_ST_PAGE) ) {
-        ::fprintf( stderr, "more than one line with '%s' at begin\n", LN_START_PAGE );
-      }
       std::string v_file_name;
+      int v_page_id = 0;
       if ( !get_value( v_line, "file", v_file_name ) ) {
         return false;
       }
-      if ( !load_tga_file( v_file_name.c_str(), a_dst ) ) {
+      get_value( v_line, "id", v_page_id );
+      if ( v_page_id < 0 || v_page_id >= MAX_PAGES_COUNT ) {
+        ::fprintf( stderr, "page id %d out of range\n", v_page_id );
         return false;
       }
+      if ( v_page_id >= (int)a_dst.m_pages.size() ) {
+        a_dst.m_pages.resize( v_page_id + 1 );
+      }
+      if ( !a_dst.m_pages[v_page_id].empty() ) {
+        ::fprintf( stderr, "more than one line with '%s' for page %d\n", LN_START_PAGE, v_page_id );
+      }
+      // pages file names are relative to font description
+      if ( '/' != v_file_name.front() ) {
+        v_file_name.insert( 0, a_dst.m_desc_dir );
+      }
+      a_dst.m_pages[v_page_id] = v_file_name;
       v_info_read_state |= RD_ST_PAGE;
       continue;
     }
@@ -272,6 +385,14 @@ bool load_font_desc( FILE * a_fp, source_font_desc_s & a_dst ) {
         || !get_value( v_line, "xadvance", a_dst.m_symbols[v_char_idx].m_x_advance ) ) {
         return false;
       }
+      // page is optional for single page fonts
+      get_value( v_line, "page", a_dst.m_symbols[v_char_idx].m_page );
+      if ( a_dst.m_symbols[v_char_idx].m_page < 0
+        || a_dst.m_symbols[v_char_idx].m_page >= (int)a_dst.m_pages.size()
+        || a_dst.m_pages[a_dst.m_symbols[v_char_idx].m_page].empty() ) {
+        ::fprintf( stderr, "char %d refers to undefined page %d\n", a_dst.m_symbols[v_char_idx].m_code, a_dst.m_symbols[v_char_idx].m_page );
+        return false;
+      }
       // no support for offsets less than zero
       if ( a_dst.m_symbols[v_char_idx].m_x_offset < 0 ) {
         a_dst.m_symbols[v_char_idx].m_x_offset = 0;
@@ -362,7 +483,7 @@ bool get_value( char * a_src, const char * a_name, int & a_dst ) {
 }
 
 
-bool load_tga_file( const char * a_file_name, source_font_desc_s & a_dst ) {
+bool load_tga_file( const char * a_file_name, source_page_s & a_dst ) {
   ::printf( "loading file '%s'\n", a_file_name );
 
   struct stat v_stat;
@@ -440,18 +561,508 @@ bool load_tga_file( const char * a_file_name, source_font_desc_s & a_dst ) {
     ::fprintf( stderr, "file '%s' size %lu, expected %u\n", a_file_name, v_stat.st_size, v_expected_file_size );
     return false;
   }
-  // read pixel's array
-  a_dst.m_bmp.resize( v_data_bytes );
-  if ( 1 != ::fread( a_dst.m_bmp.data(), v_data_bytes, 1, v_ftga.get() ) ) {
-    ::fprintf( stderr, "can't read pixel's array from '%s'\n", a_file_name );
+  // read pixel's array line by line, keep brightness only
+  a_dst.m_width = v_tga_head.width;
+  a_dst.m_height = v_tga_head.height;
+  a_dst.m_bmp.resize( v_pixels_count );
+  std::vector<uint8_t> v_line( v_pixel_bytes * a_dst.m_width );
+  uint8_t * v_dst = a_dst.m_bmp.data();
+  for ( int y = 0; y < a_dst.m_height; ++y ) {
+    if ( 1 != ::fread( v_line.data(), v_line.size(), 1, v_ftga.get() ) ) {
+      ::fprintf( stderr, "can't read pixel's array from '%s'\n", a_file_name );
+      return false;
+    }
+    for ( size_t i = 0; i < v_line.size(); i += v_pixel_bytes ) {
+      *v_dst++ = (v_line[i] + v_line[i + 1] + v_line[i + 2]) / 3;
+    }
+  }
+  return true;
+}
+
+
+#define INFLATE_MAX_BITS      15
+#define INFLATE_LITLEN_CODES  288
+#define INFLATE_DIST_CODES    30
+#define INFLATE_CODELEN_CODES 19
+
+// lengths and distances of deflate codes 257..285 and 0..29
+static const uint16_t g_inflate_len_base[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t g_inflate_len_extra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t g_inflate_dist_base[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t g_inflate_dist_extra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+// order of code lengths codes in dynamic block header
+static const uint8_t g_inflate_codelen_order[INFLATE_CODELEN_CODES] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+
+// huffman decoding table, indexed by next m_bits bits of stream,
+// each entry is symbol in low 12 bits and code length in high 4 bits (0 - invalid code)
+struct inflate_huffman_s {
+  std::vector<uint16_t> m_table;
+  int m_bits;
+  inflate_huffman_s() : m_bits(0) {}
+};
+
+
+// deflate stream reader (RFC 1951)
+struct inflate_state_s {
+  const uint8_t * m_src;
+  size_t m_src_size;
+  size_t m_src_pos;
+  uint32_t m_bit_buf;           // bits not consumed yet, LSB first
+  int m_bit_cnt;
+  bool m_error;                 // broken or truncated stream
+  std::vector<uint8_t> & m_dst;
+  inflate_state_s( const uint8_t * a_src, size_t a_src_size, std::vector<uint8_t> & a_dst )
+    : m_src(a_src)
+    , m_src_size(a_src_size)
+    , m_src_pos(0)
+    , m_bit_buf(0)
+    , m_bit_cnt(0)
+    , m_error(false)
+    , m_dst(a_dst)
+    {}
+  // load at least a_count bits, if stream has them
+  void fill( int a_count ) {
+    while ( m_bit_cnt < a_count && m_src_pos < m_src_size ) {
+      m_bit_buf |= (uint32_t)m_src[m_src_pos++] << m_bit_cnt;
+      m_bit_cnt += 8;
+    }
+  }
+  int bits( int a_count ) {
+    fill( a_count );
+    if ( m_bit_cnt < a_count ) {
+      m_error = true;
+      return 0;
+    }
+    int v_result = m_bit_buf & ((1u << a_count) - 1);
+    m_bit_buf >>= a_count;
+    m_bit_cnt -= a_count;
+    return v_result;
+  }
+  int decode( const inflate_huffman_s & a_huff ) {
+    fill( a_huff.m_bits );
+    uint16_t v_entry = a_huff.m_table[m_bit_buf & ((1u << a_huff.m_bits) - 1)];
+    int v_len = v_entry >> 12;
+    if ( 0 == v_len || v_len > m_bit_cnt ) {
+      m_error = true;
+      return -1;
+    }
+    m_bit_buf >>= v_len;
+    m_bit_cnt -= v_len;
+    return v_entry & 0x0FFF;
+  }
+};
+
+
+// build decoding table from code lengths of a_count symbols, canonical codes
+bool inflate_build( inflate_huffman_s & a_dst, const uint8_t * a_lens, int a_count ) {
+  int v_len_count[INFLATE_MAX_BITS + 1] = { 0 };
+  a_dst.m_bits = 1;
+  for ( int i = 0; i < a_count; ++i ) {
+    ++v_len_count[a_lens[i]];
+    a_dst.m_bits = std::max( a_dst.m_bits, (int)a_lens[i] );
+  }
+  v_len_count[0] = 0;
+  int v_next_code[INFLATE_MAX_BITS + 1] = { 0 };
+  for ( int v_len = 1, v_code = 0; v_len <= INFLATE_MAX_BITS; ++v_len ) {
+    v_code = (v_code + v_len_count[v_len - 1]) << 1;
+    v_next_code[v_len] = v_code;
+  }
+  a_dst.m_table.assign( 1u << a_dst.m_bits, 0 );
+  for ( int i = 0; i < a_count; ++i ) {
+    int v_len = a_lens[i];
+    if ( 0 == v_len ) {
+      continue;
+    }
+    int v_code = v_next_code[v_len]++;
+    if ( v_code >= (1 << v_len) ) {
+      // over-subscribed code lengths
+      return false;
+    }
+    // stream holds codes MSB first
+    int v_reversed = 0;
+    for ( int b = 0; b < v_len; ++b ) {
+      v_reversed |= ((v_code >> b) & 1) << (v_len - 1 - b);
+    }
+    for ( uint32_t k = v_reversed; k < a_dst.m_table.size(); k += (1u << v_len) ) {
+      a_dst.m_table[k] = (uint16_t)(i | (v_len << 12));
+    }
+  }
+  return true;
+}
+
+
+// decode literals and matches of one block
+bool inflate_codes( inflate_state_s & a_state, const inflate_huffman_s & a_litlen, const inflate_huffman_s & a_dist ) {
+  for ( ;; ) {
+    int v_sym = a_state.decode( a_litlen );
+    if ( v_sym < 0 ) {
+      return false;
+    }
+    if ( v_sym < 256 ) {
+      a_state.m_dst.push_back( v_sym );
+      continue;
+    }
+    if ( 256 == v_sym ) {
+      return true;
+    }
+    v_sym -= 257;
+    if ( v_sym >= 29 ) {
+      return false;
+    }
+    int v_len = g_inflate_len_base[v_sym] + a_state.bits( g_inflate_len_extra[v_sym] );
+    v_sym = a_state.decode( a_dist );
+    if ( v_sym < 0 || v_sym >= INFLATE_DIST_CODES ) {
+      return false;
+    }
+    size_t v_dist = g_inflate_dist_base[v_sym] + a_state.bits( g_inflate_dist_extra[v_sym] );
+    if ( a_state.m_error || v_dist > a_state.m_dst.size() ) {
+      return false;
+    }
+    // byte by byte, source and destination may overlap
+    size_t v_from = a_state.m_dst.size() - v_dist;
+    for ( int i = 0; i < v_len; ++i ) {
+      a_state.m_dst.push_back( a_state.m_dst[v_from + i] );
+    }
+  }
+}
+
+
+// read code lengths of dynamic block and build its tables
+bool inflate_dynamic_tables( inflate_state_s & a_state, inflate_huffman_s & a_litlen, inflate_huffman_s & a_dist ) {
+  int v_litlen_count = a_state.bits( 5 ) + 257;
+  int v_dist_count = a_state.bits( 5 ) + 1;
+  int v_codelen_count = a_state.bits( 4 ) + 4;
+  uint8_t v_lens[INFLATE_LITLEN_CODES + INFLATE_DIST_CODES + 2] = { 0 };
+  for ( int i = 0; i < v_codelen_count; ++i ) {
+    v_lens[g_inflate_codelen_order[i]] = a_state.bits( 3 );
+  }
+  inflate_huffman_s v_codelen;
+  if ( a_state.m_error
+    || v_litlen_count > INFLATE_LITLEN_CODES - 2
+    || !inflate_build( v_codelen, v_lens, INFLATE_CODELEN_CODES ) ) {
     return false;
   }
-  a_dst.m_tga_pixel_bytes = v_pixel_bytes;
-  a_dst.m_tga_line_bytes = v_pixel_bytes * v_tga_head.width;
+  ::memset( v_lens, 0, sizeof(v_lens) );
+  for ( int i = 0; i < v_litlen_count + v_dist_count; ) {
+    int v_sym = a_state.decode( v_codelen );
+    int v_repeat = 1;
+    int v_len = 0;
+    if ( v_sym < 0 ) {
+      return false;
+    } else if ( v_sym < 16 ) {
+      v_len = v_sym;
+    } else if ( 16 == v_sym ) {
+      if ( 0 == i ) {
+        return false;
+      }
+      v_len = v_lens[i - 1];
+      v_repeat = 3 + a_state.bits( 2 );
+    } else if ( 17 == v_sym ) {
+      v_repeat = 3 + a_state.bits( 3 );
+    } else {
+      v_repeat = 11 + a_state.bits( 7 );
+    }
+    if ( i + v_repeat > v_litlen_count + v_dist_count ) {
+      return false;
+    }
+    for ( ; v_repeat > 0; --v_repeat ) {
+      v_lens[i++] = v_len;
+    }
+  }
+  return !a_state.m_error
+      && 0 != v_lens[256]
+      && inflate_build( a_litlen, v_lens, v_litlen_count )
+      && inflate_build( a_dist, v_lens + v_litlen_count, v_dist_count );
+}
+
+
+// decompress deflate stream, append data to a_dst
+bool inflate_data( const uint8_t * a_src, size_t a_src_size, std::vector<uint8_t> & a_dst ) {
+  inflate_state_s v_state( a_src, a_src_size, a_dst );
+  inflate_huffman_s v_fixed_litlen;
+  inflate_huffman_s v_fixed_dist;
+  inflate_huffman_s v_litlen;
+  inflate_huffman_s v_dist;
+  int v_last;
+  do {
+    v_last = v_state.bits( 1 );
+    int v_type = v_state.bits( 2 );
+    if ( 0 == v_type ) {
+      // stored block, starts at byte boundary
+      v_state.m_bit_buf >>= (v_state.m_bit_cnt & 7);
+      v_state.m_bit_cnt &= ~7;
+      int v_len = v_state.bits( 16 );
+      int v_nlen = v_state.bits( 16 );
+      if ( v_state.m_error || v_len != (~v_nlen & 0xFFFF) ) {
+        return false;
+      }
+      for ( ; v_len > 0 && v_state.m_bit_cnt > 0; --v_len ) {
+        a_dst.push_back( v_state.bits( 8 ) );
+      }
+      if ( v_state.m_src_pos + v_len > a_src_size ) {
+        return false;
+      }
+      a_dst.insert( a_dst.end(), a_src + v_state.m_src_pos, a_src + v_state.m_src_pos + v_len );
+      v_state.m_src_pos += v_len;
+    } else if ( 1 == v_type ) {
+      if ( v_fixed_litlen.m_table.empty() ) {
+        uint8_t v_lens[INFLATE_LITLEN_CODES + INFLATE_DIST_CODES];
+        ::memset( v_lens, 8, 144 );
+        ::memset( v_lens + 144, 9, 256 - 144 );
+        ::memset( v_lens + 256, 7, 280 - 256 );
+        ::memset( v_lens + 280, 8, INFLATE_LITLEN_CODES - 280 );
+        ::memset( v_lens + INFLATE_LITLEN_CODES, 5, INFLATE_DIST_CODES );
+        inflate_build( v_fixed_litlen, v_lens, INFLATE_LITLEN_CODES );
+        inflate_build( v_fixed_dist, v_lens + INFLATE_LITLEN_CODES, INFLATE_DIST_CODES );
+      }
+      if ( !inflate_codes( v_state, v_fixed_litlen, v_fixed_dist ) ) {
+        return false;
+      }
+    } else if ( 2 == v_type ) {
+      if ( !inflate_dynamic_tables( v_state, v_litlen, v_dist )
+        || !inflate_codes( v_state, v_litlen, v_dist ) ) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+  } while ( !v_last && !v_state.m_error );
+  return !v_state.m_error;
+}
+
+
+#define PNG_SIGNATURE_SIZE    8
+#define PNG_COLOR_GRAY        0
+#define PNG_COLOR_RGB         2
+#define PNG_COLOR_PALETTE     3
+#define PNG_COLOR_GRAY_ALPHA  4
+#define PNG_COLOR_RGBA        6
+
+static const uint8_t g_png_signature[PNG_SIGNATURE_SIZE] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+
+
+uint32_t get_be32( const uint8_t * a_src ) {
+  return ((uint32_t)a_src[0] << 24) | ((uint32_t)a_src[1] << 16) | ((uint32_t)a_src[2] << 8) | a_src[3];
+}
+
+
+// undo PNG filter of one row, a_prev - previous unfiltered row (zeros for first row)
+bool png_unfilter_row( uint8_t a_filter, uint8_t * a_row, const uint8_t * a_prev, int a_row_bytes, int a_pixel_bytes ) {
+  switch ( a_filter ) {
+    case 0:
+      break;
+    case 1:
+      for ( int i = a_pixel_bytes; i < a_row_bytes; ++i ) {
+        a_row[i] += a_row[i - a_pixel_bytes];
+      }
+      break;
+    case 2:
+      for ( int i = 0; i < a_row_bytes; ++i ) {
+        a_row[i] += a_prev[i];
+      }
+      break;
+    case 3:
+      for ( int i = 0; i < a_row_bytes; ++i ) {
+        int v_left = i >= a_pixel_bytes ? a_row[i - a_pixel_bytes] : 0;
+        a_row[i] += (v_left + a_prev[i]) >> 1;
+      }
+      break;
+    case 4:
+      for ( int i = 0; i < a_row_bytes; ++i ) {
+        int a = i >= a_pixel_bytes ? a_row[i - a_pixel_bytes] : 0;
+        int b = a_prev[i];
+        int c = i >= a_pixel_bytes ? a_prev[i - a_pixel_bytes] : 0;
+        int p = a + b - c;
+        int pa = abs( p - a );
+        int pb = abs( p - b );
+        int pc = abs( p - c );
+        a_row[i] += (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+      }
+      break;
+    default:
+      return false;
+  }
   return true;
 }
 
 
+// load non interlaced PNG of any color type, keep brightness only,
+// transparent pixels are blended with black background
+bool load_png_file( const char * a_file_name, source_page_s & a_dst ) {
+  ::printf( "loading file '%s'\n", a_file_name );
+  std::unique_ptr<FILE, int(*)(FILE *)> v_fpng(::fopen( a_file_name, "rb" ), ::fclose);
+  if ( !v_fpng ) {
+    ::fprintf( stderr, "can't open file '%s' for read\n", a_file_name );
+    return false;
+  }
+  uint8_t v_signature[PNG_SIGNATURE_SIZE];
+  if ( 1 != ::fread( v_signature, sizeof(v_signature), 1, v_fpng.get() )
+    || 0 != ::memcmp( v_signature, g_png_signature, sizeof(v_signature) ) ) {
+    ::fprintf( stderr, "file '%s' is not PNG\n", a_file_name );
+    return false;
+  }
+  // read chunks, IDAT data joined
+  int v_depth = 0;
+  int v_color_type = -1;
+  uint8_t v_palette[256][4];
+  ::memset( v_palette, 0xFF, sizeof(v_palette) );
+  std::vector<uint8_t> v_zdata;
+  std::vector<uint8_t> v_chunk;
+  for ( ;; ) {
+    uint8_t v_chunk_head[8];
+    if ( 1 != ::fread( v_chunk_head, sizeof(v_chunk_head), 1, v_fpng.get() ) ) {
+      ::fprintf( stderr, "unexpected end of file '%s'\n", a_file_name );
+      return false;
+    }
+    uint32_t v_size = get_be32( v_chunk_head );
+    if ( v_size > 0x7FFFFFFF ) {
+      ::fprintf( stderr, "bad chunk size in '%s'\n", a_file_name );
+      return false;
+    }
+    // data and CRC
+    v_chunk.resize( v_size + 4 );
+    if ( 1 != ::fread( v_chunk.data(), v_chunk.size(), 1, v_fpng.get() ) ) {
+      ::fprintf( stderr, "unexpected end of file '%s'\n", a_file_name );
+      return false;
+    }
+    if ( 0 == ::memcmp( v_chunk_head + 4, "IHDR", 4 ) && v_size >= 13 ) {
+      a_dst.m_width = get_be32( v_chunk.data() );
+      a_dst.m_height = get_be32( v_chunk.data() + 4 );
+      v_depth = v_chunk[8];
+      v_color_type = v_chunk[9];
+      ::printf( "size: %dx%d, bit depth: %d, color type: %d\n", a_dst.m_width, a_dst.m_height, v_depth, v_color_type );
+      if ( 0 != v_chunk[10] || 0 != v_chunk[11] || 0 != v_chunk[12] ) {
+        ::fprintf( stderr, "unsupported compression, filter or interlace method in '%s'\n", a_file_name );
+        return false;
+      }
+    } else if ( 0 == ::memcmp( v_chunk_head + 4, "PLTE", 4 ) ) {
+      for ( uint32_t i = 0; i < 256 && i * 3 + 2 < v_size; ++i ) {
+        v_palette[i][0] = v_chunk[i * 3];
+        v_palette[i][1] = v_chunk[i * 3 + 1];
+        v_palette[i][2] = v_chunk[i * 3 + 2];
+      }
+    } else if ( 0 == ::memcmp( v_chunk_head + 4, "tRNS", 4 ) && PNG_COLOR_PALETTE == v_color_type ) {
+      for ( uint32_t i = 0; i < 256 && i < v_size; ++i ) {
+        v_palette[i][3] = v_chunk[i];
+      }
+    } else if ( 0 == ::memcmp( v_chunk_head + 4, "IDAT", 4 ) ) {
+      v_zdata.insert( v_zdata.end(), v_chunk.begin(), v_chunk.end() - 4 );
+    } else if ( 0 == ::memcmp( v_chunk_head + 4, "IEND", 4 ) ) {
+      break;
+    }
+  }
+  // check format
+  int v_channels = 0;
+  switch ( v_color_type ) {
+    case PNG_COLOR_GRAY:
+      v_channels = (1 == v_depth || 2 == v_depth || 4 == v_depth || 8 == v_depth || 16 == v_depth) ? 1 : 0;
+      break;
+    case PNG_COLOR_PALETTE:
+      v_channels = (1 == v_depth || 2 == v_depth || 4 == v_depth || 8 == v_depth) ? 1 : 0;
+      break;
+    case PNG_COLOR_RGB:
+    case PNG_COLOR_GRAY_ALPHA:
+    case PNG_COLOR_RGBA:
+      v_channels = (8 == v_depth || 16 == v_depth) ? (v_color_type == PNG_COLOR_GRAY_ALPHA ? 2 : v_color_type == PNG_COLOR_RGB ? 3 : 4) : 0;
+      break;
+    default:
+      break;
+  }
+  if ( 0 == v_channels || a_dst.m_width <= 0 || a_dst.m_height <= 0 ) {
+    ::fprintf( stderr, "unsupported PNG format in '%s'\n", a_file_name );
+    return false;
+  }
+  // zlib header, deflate without preset dictionary
+  if ( v_zdata.size() < 2
+    || 8 != (v_zdata[0] & 0x0F)
+    || 0 != (((v_zdata[0] << 8) | v_zdata[1]) % 31)
+    || 0 != (v_zdata[1] & 0x20) ) {
+    ::fprintf( stderr, "bad zlib header in '%s'\n", a_file_name );
+    return false;
+  }
+  int v_row_bytes = (int)(((int64_t)a_dst.m_width * v_channels * v_depth + 7) / 8);
+  int v_pixel_bytes = std::max( 1, v_channels * v_depth / 8 );
+  std::vector<uint8_t> v_raw;
+  v_raw.reserve( (size_t)(v_row_bytes + 1) * a_dst.m_height );
+  if ( !inflate_data( v_zdata.data() + 2, v_zdata.size() - 2, v_raw )
+    || v_raw.size() < (size_t)(v_row_bytes + 1) * a_dst.m_height ) {
+    ::fprintf( stderr, "broken image data in '%s'\n", a_file_name );
+    return false;
+  }
+  std::vector<uint8_t>().swap( v_zdata );
+  // unfilter and convert rows
+  a_dst.m_bmp.resize( (size_t)a_dst.m_width * a_dst.m_height );
+  std::vector<uint8_t> v_zero_row( v_row_bytes, 0 );
+  const uint8_t * v_prev = v_zero_row.data();
+  int v_sample_step = v_depth / 8;
+  int v_max_sample = (1 << std::min( v_depth, 8 )) - 1;
+  for ( int y = 0; y < a_dst.m_height; ++y ) {
+    uint8_t * v_row = &v_raw[(size_t)y * (v_row_bytes + 1)];
+    if ( !png_unfilter_row( v_row[0], v_row + 1, v_prev, v_row_bytes, v_pixel_bytes ) ) {
+      ::fprintf( stderr, "bad filter type %d in '%s'\n", v_row[0], a_file_name );
+      return false;
+    }
+    ++v_row;
+    v_prev = v_row;
+    uint8_t * v_dst = &a_dst.m_bmp[(size_t)y * a_dst.m_width];
+    for ( int x = 0; x < a_dst.m_width; ++x ) {
+      // samples, 16 bits ones are cut to high byte
+      int v_samples[4];
+      if ( v_depth < 8 ) {
+        int v_bit = x * v_depth;
+        v_samples[0] = (v_row[v_bit >> 3] >> (8 - v_depth - (v_bit & 7))) & v_max_sample;
+      } else {
+        for ( int c = 0; c < v_channels; ++c ) {
+          v_samples[c] = v_row[(x * v_channels + c) * v_sample_step];
+        }
+      }
+      int v_bright;
+      int v_alpha = 255;
+      switch ( v_color_type ) {
+        case PNG_COLOR_GRAY:
+          v_bright = v_samples[0] * 255 / v_max_sample;
+          break;
+        case PNG_COLOR_PALETTE:
+          v_bright = (v_palette[v_samples[0]][0] + v_palette[v_samples[0]][1] + v_palette[v_samples[0]][2]) / 3;
+          v_alpha = v_palette[v_samples[0]][3];
+          break;
+        case PNG_COLOR_GRAY_ALPHA:
+          v_bright = v_samples[0];
+          v_alpha = v_samples[1];
+          break;
+        case PNG_COLOR_RGB:
+          v_bright = (v_samples[0] + v_samples[1] + v_samples[2]) / 3;
+          break;
+        default:
+          v_bright = (v_samples[0] + v_samples[1] + v_samples[2]) / 3;
+          v_alpha = v_samples[3];
+          break;
+      }
+      *v_dst++ = (v_bright * v_alpha + 127) / 255;
+    }
+  }
+  return true;
+}
+
+
+bool load_page_file( const char * a_file_name, source_page_s & a_dst ) {
+  // PNG by signature, targa else
+  uint8_t v_signature[PNG_SIGNATURE_SIZE] = { 0 };
+  std::unique_ptr<FILE, int(*)(FILE *)> v_fp(::fopen( a_file_name, "rb" ), ::fclose);
+  if ( !v_fp ) {
+    ::fprintf( stderr, "can't open file '%s' for read\n", a_file_name );
+    return false;
+  }
+  size_t v_read = ::fread( v_signature, 1, sizeof(v_signature), v_fp.get() );
+  v_fp.reset();
+  if ( sizeof(v_signature) == v_read && 0 == ::memcmp( v_signature, g_png_signature, sizeof(v_signature) ) ) {
+    return load_png_file( a_file_name, a_dst );
+  }
+  return load_tga_file( a_file_name, a_dst );
+}
+
+
 std::string get_packed_data_name( const source_font_desc_s & a_src ) {
   std::string v_result = a_src.m_face;
   v_result.append( "_data" );
@@ -482,95 +1093,671 @@ std::string get_define_header_name( const source_font_desc_s & a_src ) {
 }
 
 
-void write_packed_font( FILE * a_out_h, FILE * a_out_c, const source_font_desc_s & a_src ) {
+std::string get_rows_first_name( const source_font_desc_s & a_src ) {
+  std::string v_result = a_src.m_face;
+  v_result.append( "_rows_first" );
+  return v_result;
+}
+
+
+std::string get_rows_name( const source_font_desc_s & a_src ) {
+  std::string v_result = a_src.m_face;
+  v_result.append( "_rows" );
+  return v_result;
+}
+
+
+std::string get_direct_name( const source_font_desc_s & a_src ) {
+  std::string v_result = a_src.m_face;
+  v_result.append( "_direct" );
+  return v_result;
+}
+
+
+std::string get_ranges_name( const source_font_desc_s & a_src ) {
+  std::string v_result = a_src.m_face;
+  v_result.append( "_ranges" );
+  return v_result;
+}
+
+
+// add rows index entries for symbol, decoder state at start of each bitmap row,
+// packed data consumed the same way as display_char_row does
+void fill_rows_index( const std::vector<uint8_t> & a_symdata, const packed_symbol_desc_s & a_sym, std::vector<uint32_t> & a_dst ) {
+  uint32_t v_pos = (a_sym.m_offset << 1) | a_sym.m_nibble;
+  int v_counter = 0;
+  int v_color = 0;
+  for ( int y = 0; y < a_sym.m_height; ++y ) {
+    a_dst.push_back( ROWS_INDEX_ENTRY( v_pos, v_counter, v_color ) );
+    int x = 0;
+    for ( ; v_counter > 0 && x < a_sym.m_width; --v_counter, ++x ) {
+    }
+    while ( x < a_sym.m_width ) {
+      uint8_t v_byte = a_symdata.at( v_pos >> 1 );
+      uint8_t v_packed_color = (v_pos & 1) ? (v_byte & 0x0F) : (v_byte >> 4);
+      ++v_pos;
+      if ( 0 == (v_packed_color & 0x08) ) {
+        v_color = v_packed_color;
+        ++x;
+      } else {
+        v_counter = (v_packed_color & 0x07) + 1;
+        for ( ; v_counter > 0 && x < a_sym.m_width; --v_counter, ++x ) {
+        }
+      }
+    }
+  }
+}
+
+
+void write_uint32_array( FILE * a_out_c, const char * a_name, const std::vector<uint32_t> & a_src ) {
+  ::fprintf( a_out_c, "static const uint32_t %s[%d] = {\n", a_name, (int)a_src.size() );
+  int v_line_items_count = 0;
+  for ( size_t i = 0; i < a_src.size(); ++i ) {
+    if ( 0 == i ) {
+      ::fprintf( a_out_c, " " );
+    } else {
+      ::fprintf( a_out_c, "," );
+    }
+    ::fprintf( a_out_c, " 0x%08X", a_src[i] );
+    if ( ++v_line_items_count >= 8 ) {
+      ::fprintf( a_out_c, "\n" );
+      v_line_items_count = 0;
+    }
+  }
+  if ( 0 != v_line_items_count ) {
+    ::fprintf( a_out_c, "\n" );
+  }
+  ::fprintf( a_out_c, "};\n\n" );
+}
+
+
+// symbol bitmap shades with its size, key to find pixel-identical symbols; with shade tolerance pixels
+// of the same shade may be coded differently, so shades each pixel may take are in key too
+std::string get_symbol_bitmap_key( const source_symbol_desc_s & a_sym, const std::vector<uint8_t> & a_shades, const std::vector<uint8_t> & a_allowed, int a_tolerance ) {
+  std::string v_result;
+  v_result.reserve( 2 + a_shades.size() * (a_tolerance > 0 ? 2 : 1) );
+  v_result.push_back( (char)a_sym.m_width );
+  v_result.push_back( (char)a_sym.m_height );
+  v_result.append( a_shades.begin(), a_shades.end() );
+  if ( a_tolerance > 0 ) {
+    v_result.append( a_allowed.begin(), a_allowed.end() );
+  }
+  return v_result;
+}
+
+
+// shades of symbol bitmap rows one after another, as decoder consumes them, and shades each pixel may take:
+// bit per shade, own shade and neighbour shade, if brightness is within a_tolerance of its interval
+void get_symbol_shades( const source_page_s & a_page, const source_symbol_desc_s & a_sym, int a_tolerance, std::vector<uint8_t> & a_shades, std::vector<uint8_t> & a_allowed ) {
+  a_shades.clear();
+  a_allowed.clear();
+  for ( int y = 0; y < a_sym.m_height; ++y ) {
+    int v_bmp_idx = ((a_sym.m_y + y) * a_page.m_width) + a_sym.m_x;
+    for ( int x = 0; x < a_sym.m_width; ++x ) {
+      int v_brightness = a_page.m_bmp.at(v_bmp_idx++);
+      int v_shade = v_brightness >> 5;
+      uint8_t v_allowed = (uint8_t)(1 << v_shade);
+      if ( v_shade > 0 && v_brightness - a_tolerance < (v_shade << 5) ) {
+        v_allowed |= (uint8_t)(1 << (v_shade - 1));
+      }
+      if ( v_shade < 7 && v_brightness + a_tolerance >= ((v_shade + 1) << 5) ) {
+        v_allowed |= (uint8_t)(1 << (v_shade + 1));
+      }
+      a_shades.push_back( (uint8_t)v_shade );
+      a_allowed.push_back( v_allowed );
+    }
+  }
+}
+
+
+// nibbles count of greedy coding: color on change, repeat when 8 pixels of current color are collected
+int get_greedy_nibbles_count( const std::vector<uint8_t> & a_shades ) {
+  int v_result = 0;
+  int v_curr_color = 0;
+  int v_counter = 0;
+  for ( uint8_t v_color: a_shades ) {
+    if ( v_color != v_curr_color ) {
+      v_result += (v_counter > 0 ? 1 : 0) + 1;
+      v_curr_color = v_color;
+      v_counter = 0;
+    } else if ( ++v_counter >= 8 ) {
+      ++v_result;
+      v_counter = 0;
+    }
+  }
+  return v_result + (v_counter > 0 ? 1 : 0);
+}
+
+
+// shortest nibbles sequence (color 0..7 or repeat 8..15 of current color 1..8 times, runs cross rows)
+// decoded into allowed shades of pixels, dynamic programming over pixels and current color;
+// among shortest sequences longest repeats and own shades are taken first, so for lossless coding
+// nibbles are the same as greedy ones; a_decoded - shades decoder gets
+void encode_symbol_optimal( const std::vector<uint8_t> & a_shades, const std::vector<uint8_t> & a_allowed, std::vector<uint8_t> & a_nibbles, std::vector<uint8_t> & a_decoded ) {
+  const int v_colors = 8;
+  int v_count = (int)a_shades.size();
+  // pixels from each one allowing each color, up to repeat length
+  std::vector<uint8_t> v_run( (v_count + 1) * v_colors, 0 );
+  for ( int i = v_count - 1; i >= 0; --i ) {
+    for ( int c = 0; c < v_colors; ++c ) {
+      if ( 0 != (a_allowed[i] & (1 << c)) ) {
+        v_run[i * v_colors + c] = (uint8_t)std::min( 8, v_run[(i + 1) * v_colors + c] + 1 );
+      }
+    }
+  }
+  // nibbles to code pixels from each one with each current color
+  std::vector<int> v_cost( (v_count + 1) * v_colors, 0 );
+  for ( int i = v_count - 1; i >= 0; --i ) {
+    int v_best_color = INT32_MAX;
+    for ( int c = 0; c < v_colors; ++c ) {
+      if ( 0 != (a_allowed[i] & (1 << c)) ) {
+        v_best_color = std::min( v_best_color, 1 + v_cost[(i + 1) * v_colors + c] );
+      }
+    }
+    for ( int c = 0; c < v_colors; ++c ) {
+      int v_best = v_best_color;
+      for ( int r = 1; r <= v_run[i * v_colors + c]; ++r ) {
+        v_best = std::min( v_best, 1 + v_cost[(i + r) * v_colors + c] );
+      }
+      v_cost[i * v_colors + c] = v_best;
+    }
+  }
+  // walk through shortest sequence, decoder starts with color 0
+  a_nibbles.clear();
+  a_decoded.clear();
+  int v_curr_color = 0;
+  for ( int i = 0; i < v_count; ) {
+    int v_cost_here = v_cost[i * v_colors + v_curr_color];
+    int r = v_run[i * v_colors + v_curr_color];
+    for ( ; r > 0 && 1 + v_cost[(i + r) * v_colors + v_curr_color] != v_cost_here; --r ) {
+    }
+    if ( r > 0 ) {
+      a_nibbles.push_back( (uint8_t)((r - 1) | 0x08) );
+      a_decoded.insert( a_decoded.end(), r, (uint8_t)v_curr_color );
+      i += r;
+      continue;
+    }
+    // own shade first, one of allowed colors is on shortest sequence
+    int v_color = a_shades[i];
+    for ( int c = 0; 0 == (a_allowed[i] & (1 << v_color)) || 1 + v_cost[(i + 1) * v_colors + v_color] != v_cost_here; ++c ) {
+      v_color = c;
+    }
+    a_nibbles.push_back( (uint8_t)v_color );
+    a_decoded.push_back( (uint8_t)v_color );
+    v_curr_color = v_color;
+    ++i;
+  }
+}
+
+
+// huffman coding tokens: color 0..7 or run of current color with TOKEN_RUN_FLAG
+#define TOKEN_RUN_FLAG  0x80000000u
+#define TOKEN_MAX_RUN   (16u << (HUFFMAN_LONG_RUNS - 1))
+
+
+std::string get_compact_name( const source_font_desc_s & a_src, const char * a_suffix ) {
+  std::string v_result = a_src.m_face;
+  v_result.append( "_compact" );
+  v_result.append( a_suffix );
+  return v_result;
+}
+
+
+std::string get_huffman_name( const source_font_desc_s & a_src, const char * a_suffix ) {
+  std::string v_result = a_src.m_face;
+  v_result.append( "_huffman" );
+  v_result.append( a_suffix );
+  return v_result;
+}
+
+
+// split symbol shades into colors and runs of current color, runs are not limited by 8 pixels
+void tokenize_symbol( const std::vector<uint8_t> & a_shades, std::vector<uint32_t> & a_dst ) {
+  int v_curr_color = 0;
+  uint32_t v_run = 0;
+  for ( uint8_t v_color: a_shades ) {
+    if ( v_color == v_curr_color ) {
+      ++v_run;
+      continue;
+    }
+    for ( ; v_run > 0; v_run -= std::min( v_run, TOKEN_MAX_RUN ) ) {
+      a_dst.push_back( TOKEN_RUN_FLAG | std::min( v_run, TOKEN_MAX_RUN ) );
+    }
+    a_dst.push_back( v_color );
+    v_curr_color = v_color;
+  }
+  for ( ; v_run > 0; v_run -= std::min( v_run, TOKEN_MAX_RUN ) ) {
+    a_dst.push_back( TOKEN_RUN_FLAG | std::min( v_run, TOKEN_MAX_RUN ) );
+  }
+}
+
+
+// huffman symbol of token, with extra bits for long runs
+int get_huffman_symbol( uint32_t a_token, int & a_extra_bits, uint32_t & a_extra ) {
+  a_extra_bits = 0;
+  a_extra = 0;
+  if ( 0 == (a_token & TOKEN_RUN_FLAG) ) {
+    return a_token;
+  }
+  uint32_t v_run = a_token & ~TOKEN_RUN_FLAG;
+  if ( v_run <= 8 ) {
+    return HUFFMAN_SYMBOL_RUN - 1 + v_run;
+  }
+  int n = 0;
+  while ( (16u << n) < v_run ) {
+    ++n;
+  }
+  a_extra_bits = 3 + n;
+  a_extra = v_run - 1 - (8u << n);
+  return HUFFMAN_SYMBOL_LONG_RUN + n;
+}
+
+
+// huffman code lengths for symbols frequencies, frequencies are halved until longest code fits a_max_bits
+std::vector<int> build_huffman_lengths( std::vector<uint64_t> a_freqs, int a_max_bits ) {
+  typedef std::pair<uint64_t, int> node_s;
+  for ( ;; ) {
+    std::vector<int> v_lens( a_freqs.size(), 0 );
+    std::vector<int> v_parent( a_freqs.size(), -1 );
+    std::priority_queue<node_s, std::vector<node_s>, std::greater<node_s> > v_queue;
+    for ( size_t i = 0; i < a_freqs.size(); ++i ) {
+      if ( a_freqs[i] > 0 ) {
+        v_queue.push( node_s( a_freqs[i], i ) );
+      }
+    }
+    if ( 1 == v_queue.size() ) {
+      v_lens[v_queue.top().second] = 1;
+      return v_lens;
+    }
+    while ( v_queue.size() > 1 ) {
+      node_s v_a = v_queue.top();
+      v_queue.pop();
+      node_s v_b = v_queue.top();
+      v_queue.pop();
+      v_parent[v_a.second] = v_parent.size();
+      v_parent[v_b.second] = v_parent.size();
+      v_queue.push( node_s( v_a.first + v_b.first, v_parent.size() ) );
+      v_parent.push_back( -1 );
+    }
+    int v_max_len = 0;
+    for ( size_t i = 0; i < a_freqs.size(); ++i ) {
+      if ( a_freqs[i] > 0 ) {
+        for ( int v_node = i; v_parent[v_node] >= 0; v_node = v_parent[v_node] ) {
+          ++v_lens[i];
+        }
+        v_max_len = std::max( v_max_len, v_lens[i] );
+      }
+    }
+    if ( v_max_len <= a_max_bits ) {
+      return v_lens;
+    }
+    for ( auto & f: a_freqs ) {
+      f = (f + 1) / 2;
+    }
+  }
+}
+
+
+// MSB first bits writer
+struct bit_writer_s {
+  std::vector<uint8_t> m_data;
+  uint64_t m_pos;
+  bit_writer_s() : m_pos(0) {}
+  void put( uint32_t a_bits, int a_count ) {
+    for ( int i = a_count - 1; i >= 0; --i, ++m_pos ) {
+      if ( (m_pos >> 3) >= m_data.size() ) {
+        m_data.push_back( 0 );
+      }
+      if ( 0 != ((a_bits >> i) & 1) ) {
+        m_data[m_pos >> 3] |= 0x80 >> (m_pos & 7);
+      }
+    }
+  }
+};
+
+
+void write_uint16_array( FILE * a_out_c, const char * a_name, const std::vector<uint16_t> & a_src ) {
+  ::fprintf( a_out_c, "static const uint16_t %s[%d] = {\n", a_name, (int)a_src.size() );
+  for ( size_t i = 0; i < a_src.size(); ++i ) {
+    ::fprintf( a_out_c, "%s 0x%04X%s", 0 == i ? " " : ",", a_src[i], (15 == (i % 16) || i + 1 == a_src.size()) ? "\n" : "" );
+  }
+  ::fprintf( a_out_c, "};\n\n" );
+}
+
+
+// write compact symbols table: codes array (16 bits if possible) and metrics records
+// with position narrowed to bytes needed for font, returns table name, tables are kept in a_binary too
+std::string write_compact_symbols( FILE * a_out_c, const source_font_desc_s & a_src, const std::vector<packed_symbol_desc_s> & a_psyms, binary_font_s & a_binary ) {
+  uint32_t v_max_code = 0;
+  uint32_t v_max_pos = 0;
+  for ( const packed_symbol_desc_s & v_psym: a_psyms ) {
+    v_max_code = std::max( v_max_code, (uint32_t)v_psym.m_code );
+    v_max_pos = std::max( v_max_pos, (uint32_t)((v_psym.m_offset << 1) | v_psym.m_nibble) );
+  }
+  int v_pos_bytes = 1;
+  while ( v_pos_bytes < 4 && v_max_pos >= (1u << (v_pos_bytes * 8)) ) {
+    ++v_pos_bytes;
+  }
+  // codes
+  std::string v_codes16_name( "0" );
+  std::string v_codes32_name( "0" );
+  int v_codes_bytes;
+  if ( v_max_code < 0x10000 ) {
+    std::vector<uint16_t> v_codes;
+    for ( const packed_symbol_desc_s & v_psym: a_psyms ) {
+      v_codes.push_back( v_psym.m_code );
+    }
+    v_codes16_name = get_compact_name( a_src, "_codes" );
+    write_uint16_array( a_out_c, v_codes16_name.c_str(), v_codes );
+    v_codes_bytes = (int)(v_codes.size() * sizeof(uint16_t));
+    a_binary.set( FONT_FILE_CODES16, v_codes );
+  } else {
+    std::vector<uint32_t> v_codes;
+    for ( const packed_symbol_desc_s & v_psym: a_psyms ) {
+      v_codes.push_back( v_psym.m_code );
+    }
+    v_codes32_name = get_compact_name( a_src, "_codes" );
+    write_uint32_array( a_out_c, v_codes32_name.c_str(), v_codes );
+    v_codes_bytes = (int)(v_codes.size() * sizeof(uint32_t));
+    a_binary.set( FONT_FILE_CODES32, v_codes );
+  }
+  // metrics, one record per line
+  std::string v_metrics_name = get_compact_name( a_src, "_metrics" );
+  int v_record_size = COMPACT_METRICS_SIZE + v_pos_bytes;
+  std::vector<uint8_t> & v_metrics = a_binary.m_sections[FONT_FILE_METRICS];
+  v_metrics.clear();
+  ::fprintf( a_out_c, "static const uint8_t %s[%d] = {\n", v_metrics_name.c_str(), (int)a_psyms.size() * v_record_size );
+  for ( size_t i = 0; i < a_psyms.size(); ++i ) {
+    const packed_symbol_desc_s & v_psym = a_psyms[i];
+    uint32_t v_pos = (v_psym.m_offset << 1) | v_psym.m_nibble;
+    ::fprintf( a_out_c, "%s %u, %u, %u, %u, %u"
+             , 0 == i ? " " : ","
+             , v_psym.m_width
+             , v_psym.m_height
+             , v_psym.m_x_offset
+             , v_psym.m_y_offset
+             , v_psym.m_x_advance
+             );
+    v_metrics.insert( v_metrics.end(), { (uint8_t)v_psym.m_width, (uint8_t)v_psym.m_height, (uint8_t)v_psym.m_x_offset, (uint8_t)v_psym.m_y_offset, (uint8_t)v_psym.m_x_advance } );
+    for ( int k = 0; k < v_pos_bytes; ++k ) {
+      ::fprintf( a_out_c, ", 0x%02X", (v_pos >> (k * 8)) & 0xFF );
+      v_metrics.push_back( (uint8_t)(v_pos >> (k * 8)) );
+    }
+    ::fprintf( a_out_c, "\n" );
+  }
+  ::fprintf( a_out_c, "};\n\n" );
+  std::string v_result = get_compact_name( a_src, "" );
+  ::fprintf( a_out_c, "static const packed_compact_symbols_s %s = { %s, %s, %s, %d };\n\n"
+           , v_result.c_str(), v_codes16_name.c_str(), v_codes32_name.c_str(), v_metrics_name.c_str(), v_pos_bytes );
+  a_binary.m_pos_bytes = v_pos_bytes;
+  ::printf( "compact symbols table: %d bytes (%d bytes of packed_symbol_desc_s array), %d bytes of position\n"
+          , v_codes_bytes + (int)a_psyms.size() * v_record_size
+          , (int)(a_psyms.size() * sizeof(packed_symbol_desc_s))
+          , v_pos_bytes );
+  return "&" + v_result;
+}
+
+
+// write binary font file: header and sections aligned to FONT_FILE_ALIGN
+bool write_font_file( const char * a_file_name, const source_font_desc_s & a_src, const binary_font_s & a_binary, int a_ranges_count, uint32_t a_bmp_size ) {
+  font_file_header_s v_header;
+  ::memset( &v_header, 0, sizeof(v_header) );
+  ::memcpy( v_header.m_magic, FONT_FILE_MAGIC, sizeof(v_header.m_magic) );
+  v_header.m_version = FONT_FILE_VERSION;
+  v_header.m_byte_order = FONT_FILE_BYTE_ORDER;
+  v_header.m_header_size = sizeof(font_file_header_s);
+  v_header.m_symbol_desc_size = sizeof(packed_symbol_desc_s);
+  v_header.m_symbols_count = a_src.m_symbols_count;
+  v_header.m_row_height = a_src.m_row_height;
+  v_header.m_def_code_idx = a_src.m_def_code_idx;
+  v_header.m_ranges_count = a_ranges_count;
+  v_header.m_bmp_size = a_bmp_size;
+  v_header.m_pos_bytes = a_binary.m_pos_bytes;
+  v_header.m_max_symbol_width = a_src.m_max_symbol_width;
+  size_t v_offset = sizeof(font_file_header_s);
+  for ( int i = 0; i < FONT_FILE_SECTIONS; ++i ) {
+    if ( a_binary.m_sections[i].empty() ) {
+      continue;
+    }
+    v_offset = (v_offset + FONT_FILE_ALIGN - 1) / FONT_FILE_ALIGN * FONT_FILE_ALIGN;
+    v_header.m_sections[i].m_offset = (uint32_t)v_offset;
+    v_header.m_sections[i].m_size = (uint32_t)a_binary.m_sections[i].size();
+    v_offset += a_binary.m_sections[i].size();
+  }
+  v_header.m_file_size = (uint32_t)v_offset;
+  std::vector<uint8_t> v_image( v_offset, 0 );
+  ::memcpy( v_image.data(), &v_header, sizeof(v_header) );
+  for ( int i = 0; i < FONT_FILE_SECTIONS; ++i ) {
+    if ( !a_binary.m_sections[i].empty() ) {
+      ::memcpy( v_image.data() + v_header.m_sections[i].m_offset, a_binary.m_sections[i].data(), a_binary.m_sections[i].size() );
+    }
+  }
+  std::unique_ptr<FILE, int(*)(FILE *)> v_fp(::fopen( a_file_name, "wb" ), ::fclose);
+  if ( !v_fp ) {
+    ::fprintf( stderr, "can't open file '%s' for write\n", a_file_name );
+    return false;
+  }
+  if ( v_image.size() != ::fwrite( v_image.data(), 1, v_image.size(), v_fp.get() ) ) {
+    ::fprintf( stderr, "can't write file '%s'\n", a_file_name );
+    return false;
+  }
+  ::printf( "binary font file: %d bytes\n", (int)v_image.size() );
+  return true;
+}
+
+
+// write C++17 header with constexpr symbols metrics, for constexpr_text_extent() of font_bmp_constexpr.h
+bool write_constexpr_header( const char * a_file_name, const source_font_desc_s & a_src ) {
+  std::unique_ptr<FILE, int(*)(FILE *)> v_fp(::fopen( a_file_name, "wb" ), ::fclose);
+  if ( !v_fp ) {
+    ::fprintf( stderr, "can't open file '%s' for write\n", a_file_name );
+    return false;
+  }
+  FILE * v_out = v_fp.get();
+  std::string v_define_name( a_file_name );
+  replace_extra_symbols( v_define_name );
+  v_define_name.insert( v_define_name.begin(), {'_', '_'} );
+  v_define_name.append( "__" );
+  std::string v_metrics_name = a_src.m_face + "_metrics";
+  ::fprintf( v_out, "#ifndef %s\n#define %s\n\n#include \"font_bmp_constexpr.h\"\n\n", v_define_name.c_str(), v_define_name.c_str() );
+  ::fprintf( v_out, "inline constexpr constexpr_symbol_s %s_symbols[%d] = {\n", v_metrics_name.c_str(), a_src.m_symbols_count );
+  int v_line_items_count = 0;
+  for ( int i = 0; i < a_src.m_symbols_count; ++i ) {
+    ::fprintf( v_out, "%s { %d, %d }", 0 == i ? " " : ",", a_src.m_symbols[i].m_code, a_src.m_symbols[i].m_x_advance );
+    if ( ++v_line_items_count >= 8 ) {
+      ::fprintf( v_out, "\n" );
+      v_line_items_count = 0;
+    }
+  }
+  if ( 0 != v_line_items_count ) {
+    ::fprintf( v_out, "\n" );
+  }
+  ::fprintf( v_out, "};\n\n" );
+  ::fprintf( v_out
+           , "inline constexpr constexpr_font_s %s = { %s_symbols, %d, %d, %d };\n\n#endif // %s\n"
+           , v_metrics_name.c_str()
+           , v_metrics_name.c_str()
+           , a_src.m_symbols_count
+           , a_src.m_row_height
+           , a_src.m_def_code_idx
+           , v_define_name.c_str()
+           );
+  return true;
+}
+
+
+bool write_packed_font( FILE * a_out_h, FILE * a_out_c, const source_font_desc_s & a_src, const convert_options_s & a_options ) {
   // write out font files
   ::printf( "write font files\n" );
   // prepare packet bmp array
   bool v_curr_nibble = false; // current nibble to write, false - high, true - low
   uint8_t v_curr_byte = 0; // current byte to write
   std::vector<uint8_t> v_symdata; // bmp array
-  v_symdata.resize( a_src.m_bmp_width * a_src.m_bmp_height / 2 );
+  // no more than one nibble for each pixel
+  size_t v_symdata_size = 1;
+  for ( const source_symbol_desc_s &s: a_src.m_symbols ) {
+    v_symdata_size += (s.m_width * s.m_height + 1) / 2 + 1;
+  }
+  v_symdata.resize( v_symdata_size );
   // packed symbols desc
   std::vector<packed_symbol_desc_s> v_psyms;
   v_psyms.resize(a_src.m_symbols_count);
-  // symbol index
-  int v_sym_idx = 0;
   // index of byte to write into v_sym_data
   int v_write_idx = 0;
-  // 
-  for ( const source_symbol_desc_s &s: a_src.m_symbols ) {
-    // fill packed symbol info
-    s.fill_packed( v_psyms[v_sym_idx++], v_write_idx, v_curr_nibble );
-    // calc idx in pixels array
-    int v_bmp_idx = (s.m_y * a_src.m_tga_line_bytes) + (s.m_x * a_src.m_tga_pixel_bytes);
-    // current color 0
-    int v_curr_color = 0;
-    int v_curr_color_counter = 0;
-    for ( int y = 0; y < s.m_height; ++y ) {
-      for ( int x = 0; x < s.m_width; ++x ) {
-        int v_color = ((a_src.m_bmp.at(v_bmp_idx) + a_src.m_bmp.at(v_bmp_idx + 1) + a_src.m_bmp.at(v_bmp_idx + 2)) / 3) >> 5;
-        if ( v_color != v_curr_color ) {
-          // first check v_curr_color_counter
-          if ( v_curr_color_counter > 0 ) {
-            if ( v_curr_nibble ) {
-              v_curr_byte |= (v_curr_color_counter - 1) | 0x8;
-              v_symdata[v_write_idx++] = v_curr_byte;
-              v_curr_nibble = false;
-              v_curr_byte = 0;
-            } else {
-              v_curr_byte |= ((v_curr_color_counter - 1) | 0x8) << 4;
-              v_curr_nibble = true;
-            }
-            v_curr_color_counter = 0;
-          }
-          v_curr_color = v_color;
-          //
-          if ( v_curr_nibble ) {
-            v_curr_byte |= v_color;
-            v_symdata[v_write_idx++] = v_curr_byte;
-            v_curr_nibble = false;
-            v_curr_byte = 0;
-          } else {
-            v_curr_byte |= v_color << 4;
-            v_curr_nibble = true;
-          }
+  // huffman coding tokens of symbols, in packing order
+  std::vector<uint32_t> v_tokens;
+  std::vector<std::pair<size_t, size_t> > v_tokens_ranges( a_src.m_symbols_count );
+  std::vector<int> v_packing_order;
+  // pixel-identical symbols share packed data: first symbol with the same bitmap, nibbles of packed symbols
+  std::unordered_map<std::string, int> v_bitmaps;
+  std::vector<int> v_same_as( a_src.m_symbols_count, -1 );
+  std::vector<int> v_nibbles( a_src.m_symbols_count, 0 );
+  int v_same_nibbles = 0;
+  int v_same_count = 0;
+  // run-length coding of each symbol
+  std::vector<uint8_t> v_shades;
+  std::vector<uint8_t> v_allowed;
+  std::vector<uint8_t> v_packed;
+  std::vector<uint8_t> v_decoded;
+  int v_greedy_nibbles = 0;
+  int v_optimal_nibbles = 0;
+  // only one page image in memory, symbols of page are packed in codes order
+  source_page_s v_page;
+  for ( int v_page_id = 0; v_page_id < (int)a_src.m_pages.size(); ++v_page_id ) {
+    bool v_page_loaded = false;
+    for ( int v_sym_idx = 0; v_sym_idx < a_src.m_symbols_count; ++v_sym_idx ) {
+      const source_symbol_desc_s &s = a_src.m_symbols[v_sym_idx];
+      if ( s.m_page != v_page_id ) {
+        continue;
+      }
+      if ( !v_page_loaded ) {
+        if ( !load_page_file( a_src.m_pages[v_page_id].c_str(), v_page ) ) {
+          return false;
+        }
+        v_page_loaded = true;
+      }
+      if ( s.m_x < 0 || s.m_y < 0 || s.m_x + s.m_width > v_page.m_width || s.m_y + s.m_height > v_page.m_height ) {
+        ::fprintf( stderr, "char %d is out of page %d bounds\n", s.m_code, v_page_id );
+        return false;
+      }
+      get_symbol_shades( v_page, s, a_options.m_shade_tolerance, v_shades, v_allowed );
+      auto v_bitmap = v_bitmaps.emplace( get_symbol_bitmap_key( s, v_shades, v_allowed, a_options.m_shade_tolerance ), v_sym_idx );
+      if ( !v_bitmap.second ) {
+        // duplicate, refer to packed data of first one
+        int v_first = v_bitmap.first->second;
+        v_same_as[v_sym_idx] = v_first;
+        s.fill_packed( v_psyms[v_sym_idx], v_psyms[v_first].m_offset, v_psyms[v_first].m_nibble );
+        v_same_nibbles += v_nibbles[v_first];
+        ++v_same_count;
+        continue;
+      }
+      int v_start_nibble = (v_write_idx << 1) | (v_curr_nibble ? 1 : 0);
+      // fill packed symbol info
+      s.fill_packed( v_psyms[v_sym_idx], v_write_idx, v_curr_nibble );
+      // shortest run-length coding, compared with greedy one
+      encode_symbol_optimal( v_shades, v_allowed, v_packed, v_decoded );
+      int v_greedy = get_greedy_nibbles_count( v_shades );
+      v_greedy_nibbles += v_greedy;
+      v_optimal_nibbles += (int)v_packed.size();
+      if ( v_greedy > (int)v_packed.size() ) {
+        ::printf( "  char %d: %d nibbles, greedy %d nibbles\n", s.m_code, (int)v_packed.size(), v_greedy );
+      }
+      if ( a_options.m_huffman ) {
+        v_tokens_ranges[v_sym_idx].first = v_tokens.size();
+        tokenize_symbol( v_decoded, v_tokens );
+        v_tokens_ranges[v_sym_idx].second = v_tokens.size();
+        v_packing_order.push_back( v_sym_idx );
+      }
+      for ( uint8_t v_nibble: v_packed ) {
+        if ( v_curr_nibble ) {
+          v_curr_byte |= v_nibble;
+          v_symdata[v_write_idx++] = v_curr_byte;
+          v_curr_nibble = false;
+          v_curr_byte = 0;
         } else {
-          // each counter from 1 to 8
-          if ( ++v_curr_color_counter >= 8 ) {
-            if ( v_curr_nibble ) {
-              v_curr_byte |= 0x0F;
-              v_symdata[v_write_idx++] = v_curr_byte;
-              v_curr_nibble = false;
-              v_curr_byte = 0;
-            } else {
-              v_curr_byte |= 0xF0;
-              v_curr_nibble = true;
-            }
-            v_curr_color_counter = 0;
-          }
+          v_curr_byte = v_nibble << 4;
+          v_curr_nibble = true;
         }
-        v_bmp_idx += a_src.m_tga_pixel_bytes;
-      }
-      v_bmp_idx += (a_src.m_bmp_width - s.m_width) * a_src.m_tga_pixel_bytes;
-    }
-    // check v_curr_color_counter
-    if ( v_curr_color_counter > 0 ) {
-      // write last nibble of symbol
-      if ( v_curr_nibble ) {
-        v_curr_byte |= (v_curr_color_counter - 1) | 0x8;
-        v_symdata[v_write_idx++] = v_curr_byte;
-        v_curr_nibble = false;
-        v_curr_byte = 0;
-      } else {
-        v_curr_byte |= ((v_curr_color_counter - 1) | 0x8) << 4;
-        v_curr_nibble = true;
       }
+      v_nibbles[v_sym_idx] = ((v_write_idx << 1) | (v_curr_nibble ? 1 : 0)) - v_start_nibble;
     }
   }
   // last nibble
   if ( v_curr_nibble ) {
     v_symdata[v_write_idx++] = v_curr_byte;
   }
+  ::printf( "duplicate symbols: %d, saved %d bytes\n", v_same_count, v_same_nibbles / 2 );
+  ::printf( "run-length coding: %d nibbles, greedy %d nibbles, saved %d bytes\n"
+          , v_optimal_nibbles, v_greedy_nibbles, (v_greedy_nibbles - v_optimal_nibbles) / 2 );
+  // huffman code built from font statistics, used if data with tables is smaller than nibbles
+  bool v_huffman = false;
+  std::vector<uint16_t> v_huffman_lookup( 1 << HUFFMAN_LOOKUP_BITS, 0 );
+  std::vector<uint16_t> v_huffman_counts( HUFFMAN_MAX_BITS + 1, 0 );
+  std::vector<uint8_t> v_huffman_symbols;
+  if ( a_options.m_huffman ) {
+    int v_extra_bits;
+    uint32_t v_extra;
+    std::vector<uint64_t> v_freqs( HUFFMAN_SYMBOLS, 0 );
+    for ( uint32_t v_token: v_tokens ) {
+      ++v_freqs[get_huffman_symbol( v_token, v_extra_bits, v_extra )];
+    }
+    std::vector<int> v_lens = build_huffman_lengths( v_freqs, HUFFMAN_MAX_BITS );
+    // canonical codes, ordered by length and symbol
+    std::vector<uint32_t> v_codes( HUFFMAN_SYMBOLS, 0 );
+    uint32_t v_code = 0;
+    for ( int v_len = 1; v_len <= HUFFMAN_MAX_BITS; ++v_len ) {
+      for ( int v_sym = 0; v_sym < HUFFMAN_SYMBOLS; ++v_sym ) {
+        if ( v_lens[v_sym] != v_len ) {
+          continue;
+        }
+        v_codes[v_sym] = v_code++;
+        ++v_huffman_counts[v_len];
+        v_huffman_symbols.push_back( v_sym );
+        if ( v_len <= HUFFMAN_LOOKUP_BITS ) {
+          int v_shift = HUFFMAN_LOOKUP_BITS - v_len;
+          for ( uint32_t k = 0; k < (1u << v_shift); ++k ) {
+            v_huffman_lookup[(v_codes[v_sym] << v_shift) | k] = HUFFMAN_LOOKUP_ENTRY( v_len, v_sym );
+          }
+        }
+      }
+      v_code <<= 1;
+    }
+    // symbols at the same places as nibbles ones
+    bit_writer_s v_writer;
+    std::vector<packed_symbol_desc_s> v_huffman_psyms( v_psyms );
+    for ( int v_sym_idx: v_packing_order ) {
+      v_huffman_psyms[v_sym_idx].m_offset = (uint32_t)(v_writer.m_pos >> 1);
+      v_huffman_psyms[v_sym_idx].m_nibble = (uint32_t)(v_writer.m_pos & 1);
+      for ( size_t i = v_tokens_ranges[v_sym_idx].first; i < v_tokens_ranges[v_sym_idx].second; ++i ) {
+        int v_sym = get_huffman_symbol( v_tokens[i], v_extra_bits, v_extra );
+        v_writer.put( v_codes[v_sym], v_lens[v_sym] );
+        v_writer.put( v_extra, v_extra_bits );
+      }
+    }
+    for ( int i = 0; i < a_src.m_symbols_count; ++i ) {
+      if ( v_same_as[i] >= 0 ) {
+        v_huffman_psyms[i].m_offset = v_huffman_psyms[v_same_as[i]].m_offset;
+        v_huffman_psyms[i].m_nibble = v_huffman_psyms[v_same_as[i]].m_nibble;
+      }
+    }
+    // decoder reads 3 bytes at once
+    v_writer.m_data.resize( v_writer.m_data.size() + 2, 0 );
+    int v_tables_bytes = (int)((v_huffman_lookup.size() + v_huffman_counts.size()) * sizeof(uint16_t) + v_huffman_symbols.size());
+    ::printf( "packed data: %d bytes, huffman coded: %d bytes with %d bytes of tables\n"
+            , v_write_idx, (int)v_writer.m_data.size() + v_tables_bytes, v_tables_bytes );
+    if ( (int)v_writer.m_data.size() + v_tables_bytes < v_write_idx && (v_writer.m_pos >> 1) < 0x80000000u ) {
+      v_huffman = true;
+      v_symdata.swap( v_writer.m_data );
+      v_write_idx = (int)v_symdata.size();
+      v_psyms.swap( v_huffman_psyms );
+    } else {
+      ::printf( "huffman coding doesn't make data smaller, nibbles are used\n" );
+    }
+  }
+  // tables for binary font file, packed data with zero bytes for read ahead
+  binary_font_s v_binary;
+  v_binary.m_sections[FONT_FILE_BMP].assign( v_symdata.begin(), v_symdata.begin() + v_write_idx );
+  v_binary.m_sections[FONT_FILE_BMP].resize( v_write_idx + FONT_FILE_BMP_PADDING, 0 );
   // includes
   std::string v_define_header_name = get_define_header_name( a_src );
   ::fprintf( a_out_h
@@ -600,27 +1787,137 @@ void write_packed_font( FILE * a_out_h, FILE * a_out_c, const source_font_desc_s
   }
   ::fprintf( a_out_c, "};\n\n" );
   // write symbols description
-  std::string v_packes_symbols_name = get_packed_symbols_name( a_src );
-  ::fprintf( a_out_c, "static const packed_symbol_desc_s %s[%d] = {\n", v_packes_symbols_name.c_str(), a_src.m_symbols_count );
-  for ( int i = 0; i < a_src.m_symbols_count; ++i ) {
-    if ( 0 == i ) {
-      ::fprintf( a_out_c, " " );
-    } else {
-      ::fprintf( a_out_c, "," );
+  std::string v_packes_symbols_name( "0" );
+  std::string v_compact_name( "0" );
+  if ( a_options.m_compact_symbols ) {
+    v_compact_name = write_compact_symbols( a_out_c, a_src, v_psyms, v_binary );
+  } else {
+    v_packes_symbols_name = get_packed_symbols_name( a_src );
+    ::fprintf( a_out_c, "static const packed_symbol_desc_s %s[%d] = {\n", v_packes_symbols_name.c_str(), a_src.m_symbols_count );
+    for ( int i = 0; i < a_src.m_symbols_count; ++i ) {
+      if ( 0 == i ) {
+        ::fprintf( a_out_c, " " );
+      } else {
+        ::fprintf( a_out_c, "," );
+      }
+      ::fprintf( a_out_c
+               , " {%u, %u, %u, %u, %u, %u, %u, %u}\n"
+               , v_psyms.at(i).m_code
+               , v_psyms.at(i).m_offset
+               , v_psyms.at(i).m_nibble
+               , v_psyms.at(i).m_width
+               , v_psyms.at(i).m_height
+               , v_psyms.at(i).m_x_offset
+               , v_psyms.at(i).m_y_offset
+               , v_psyms.at(i).m_x_advance
+               );
     }
-    ::fprintf( a_out_c
-             , " {%u, %u, %u, %u, %u, %u, %u, %u}\n"
-             , v_psyms.at(i).m_code
-             , v_psyms.at(i).m_offset
-             , v_psyms.at(i).m_nibble
-             , v_psyms.at(i).m_width
-             , v_psyms.at(i).m_height
-             , v_psyms.at(i).m_x_offset
-             , v_psyms.at(i).m_y_offset
-             , v_psyms.at(i).m_x_advance
-             );
+    ::fprintf( a_out_c, "};\n\n" );
+    v_binary.set( FONT_FILE_SYMBOLS, v_psyms );
+  }
+  // write rows index
+  std::string v_rows_first_name( "0" );
+  std::string v_rows_name( "0" );
+  if ( a_options.m_rows_index && v_huffman ) {
+    ::printf( "rows index is not written for huffman coded data\n" );
+  }
+  // end of packed data position too
+  bool v_rows_pos_fit = ((uint64_t)v_write_idx << 1) < ROWS_INDEX_POS_LIMIT;
+  if ( a_options.m_rows_index && !v_huffman && !v_rows_pos_fit ) {
+    ::printf( "rows index is not written, packed data is too big for its positions\n" );
+  }
+  if ( a_options.m_rows_index && !v_huffman && v_rows_pos_fit ) {
+    std::vector<uint32_t> v_rows_first;
+    std::vector<uint32_t> v_rows;
+    for ( const packed_symbol_desc_s & v_psym: v_psyms ) {
+      v_rows_first.push_back( v_rows.size() );
+      fill_rows_index( v_symdata, v_psym, v_rows );
+    }
+    // at least one entry for empty array
+    if ( v_rows.empty() ) {
+      v_rows.push_back( 0 );
+    }
+    v_rows_first_name = get_rows_first_name( a_src );
+    v_rows_name = get_rows_name( a_src );
+    write_uint32_array( a_out_c, v_rows_first_name.c_str(), v_rows_first );
+    write_uint32_array( a_out_c, v_rows_name.c_str(), v_rows );
+    v_binary.set( FONT_FILE_ROWS_FIRST, v_rows_first );
+    v_binary.set( FONT_FILE_ROWS, v_rows );
+    ::printf( "rows index: %d bytes\n", (int)((v_rows_first.size() + v_rows.size()) * sizeof(uint32_t)) );
+  }
+  // write lookup tables
+  std::string v_direct_name( "0" );
+  std::string v_ranges_name( "0" );
+  int v_ranges_count = 0;
+  if ( a_options.m_lookup_tables ) {
+    // direct table for small codes
+    v_direct_name = get_direct_name( a_src );
+    ::fprintf( a_out_c, "static const uint16_t %s[%d] = {\n", v_direct_name.c_str(), DIRECT_CODES_COUNT );
+    std::vector<uint16_t> v_direct( DIRECT_CODES_COUNT, DIRECT_NO_SYMBOL );
+    for ( int i = 0; i < a_src.m_symbols_count; ++i ) {
+      if ( a_src.m_symbols[i].m_code < DIRECT_CODES_COUNT ) {
+        v_direct[a_src.m_symbols[i].m_code] = i;
+      }
+    }
+    for ( int i = 0; i < DIRECT_CODES_COUNT; ++i ) {
+      ::fprintf( a_out_c, "%s 0x%04X%s", 0 == i ? " " : ",", v_direct[i], 15 == (i % 16) ? "\n" : "" );
+    }
+    ::fprintf( a_out_c, "};\n\n" );
+    v_binary.set( FONT_FILE_DIRECT, v_direct );
+    // contiguous ranges for other codes
+    std::vector<packed_code_range_s> v_ranges;
+    for ( int i = 0; i < a_src.m_symbols_count; ++i ) {
+      const source_symbol_desc_s & v_sym = a_src.m_symbols[i];
+      if ( v_sym.m_code < DIRECT_CODES_COUNT ) {
+        continue;
+      }
+      if ( v_ranges.empty()
+        || (uint32_t)v_sym.m_code != v_ranges.back().m_code + (i - v_ranges.back().m_index) ) {
+        packed_code_range_s v_range;
+        v_range.m_code = v_sym.m_code;
+        v_range.m_index = i;
+        v_ranges.push_back( v_range );
+      }
+    }
+    v_ranges_count = (int)v_ranges.size();
+    if ( v_ranges_count > 0 ) {
+      v_ranges_name = get_ranges_name( a_src );
+      ::fprintf( a_out_c, "static const packed_code_range_s %s[%d] = {\n", v_ranges_name.c_str(), v_ranges_count + 1 );
+      for ( int i = 0; i < v_ranges_count; ++i ) {
+        ::fprintf( a_out_c, "%s {%u, %u}\n", 0 == i ? " " : ",", v_ranges[i].m_code, v_ranges[i].m_index );
+      }
+      // end of last range
+      ::fprintf( a_out_c, ", {0xFFFFFFFF, %d}\n};\n\n", a_src.m_symbols_count );
+      packed_code_range_s v_end;
+      v_end.m_code = 0xFFFFFFFF;
+      v_end.m_index = a_src.m_symbols_count;
+      v_ranges.push_back( v_end );
+      v_binary.set( FONT_FILE_RANGES, v_ranges );
+    }
+    ::printf( "lookup tables: %d bytes, %d codes ranges\n"
+            , (int)(DIRECT_CODES_COUNT * sizeof(uint16_t) + (v_ranges_count > 0 ? (v_ranges_count + 1) * sizeof(packed_code_range_s) : 0))
+            , v_ranges_count );
+  }
+  // write huffman code tables
+  std::string v_huffman_name( "0" );
+  if ( v_huffman ) {
+    std::string v_lookup_name = get_huffman_name( a_src, "_lookup" );
+    std::string v_counts_name = get_huffman_name( a_src, "_counts" );
+    std::string v_symbols_name = get_huffman_name( a_src, "_symbols" );
+    write_uint16_array( a_out_c, v_lookup_name.c_str(), v_huffman_lookup );
+    write_uint16_array( a_out_c, v_counts_name.c_str(), v_huffman_counts );
+    ::fprintf( a_out_c, "static const uint8_t %s[%d] = {", v_symbols_name.c_str(), (int)v_huffman_symbols.size() );
+    for ( size_t i = 0; i < v_huffman_symbols.size(); ++i ) {
+      ::fprintf( a_out_c, "%s %u", 0 == i ? "" : ",", v_huffman_symbols[i] );
+    }
+    ::fprintf( a_out_c, " };\n\n" );
+    ::fprintf( a_out_c, "static const packed_huffman_s %s = { %s, %s, %s };\n\n"
+             , get_huffman_name( a_src, "" ).c_str(), v_lookup_name.c_str(), v_counts_name.c_str(), v_symbols_name.c_str() );
+    v_huffman_name = "&" + get_huffman_name( a_src, "" );
+    v_binary.set( FONT_FILE_HUFFMAN_LOOKUP, v_huffman_lookup );
+    v_binary.set( FONT_FILE_HUFFMAN_COUNTS, v_huffman_counts );
+    v_binary.set( FONT_FILE_HUFFMAN_SYMBOLS, v_huffman_symbols );
   }
-  ::fprintf( a_out_c, "};\n\n" );
   // write font description
   std::string v_font_desc_name = get_packed_font_name( a_src );
   ::fprintf( a_out_h
@@ -635,12 +1932,27 @@ void write_packed_font( FILE * a_out_h, FILE * a_out_c, const source_font_desc_s
            );
   ::fprintf( a_out_c, "const packed_font_desc_s %s = {\n", v_font_desc_name.c_str() );
   ::fprintf( a_out_c
-           , "%s, %d, %d, %d, %s"
+           , "%s, %d, %d, %d, %s, %s, %s, %s, %s, %d, %d, %s, %s"
            , v_packed_data_name.c_str()
            , a_src.m_symbols_count
            , a_src.m_row_height
            , a_src.m_def_code_idx
            , v_packes_symbols_name.c_str()
+           , v_rows_first_name.c_str()
+           , v_rows_name.c_str()
+           , v_direct_name.c_str()
+           , v_ranges_name.c_str()
+           , v_ranges_count
+           , v_write_idx
+           , v_huffman_name.c_str()
+           , v_compact_name.c_str()
            );
   ::fprintf( a_out_c, "\n};\n\n#ifdef __cplusplus\n}\n#endif\n" );
+  if ( a_options.m_constexpr_file_name && !write_constexpr_header( a_options.m_constexpr_file_name, a_src ) ) {
+    return false;
+  }
+  if ( a_options.m_binary_file_name ) {
+    return write_font_file( a_options.m_binary_file_name, a_src, v_binary, v_ranges_count, v_write_idx );
+  }
+  return true;
 }
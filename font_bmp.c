@@ -1,13 +1,96 @@
 #include "font_bmp.h"
 
+#include <stddef.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// binary search within sorted codes of compact symbols table
+// returns symbol index, or default symbol index if code not found
+static int find_compact_code16( const packed_font_desc_s * a_font, uint32_t a_code ) {
+  const uint16_t * v_codes = a_font->m_compact->m_codes16;
+  int l = 0;
+  int u = a_font->m_symbols_count - 1;
+  if ( a_code > 0xFFFF ) {
+    return a_font->m_def_code_idx;
+  }
+  while ( l <= u ) {
+    int m = (l + u) / 2;
+    if ( v_codes[m] == a_code ) {
+      return m;
+    }
+    if ( v_codes[m] > a_code ) {
+      u = m - 1;
+    } else {
+      l = m + 1;
+    }
+  }
+  return a_font->m_def_code_idx;
+}
+
+
+static int find_compact_code32( const packed_font_desc_s * a_font, uint32_t a_code ) {
+  const uint32_t * v_codes = a_font->m_compact->m_codes32;
+  int l = 0;
+  int u = a_font->m_symbols_count - 1;
+  while ( l <= u ) {
+    int m = (l + u) / 2;
+    if ( v_codes[m] == a_code ) {
+      return m;
+    }
+    if ( v_codes[m] > a_code ) {
+      u = m - 1;
+    } else {
+      l = m + 1;
+    }
+  }
+  return a_font->m_def_code_idx;
+}
+
+
 // find symbol desc by it's code
-// returns symbol desc index within a_font->m_symbols
+// returns symbol desc index within a_font->m_symbols (or compact symbols table)
 static int find_symbol_index( const packed_font_desc_s * a_font, uint32_t a_code ) {
+  // direct table
+  if ( a_code < DIRECT_CODES_COUNT && a_font->m_direct ) {
+    uint16_t v_idx = a_font->m_direct[a_code];
+    return DIRECT_NO_SYMBOL != v_idx ? v_idx : (int)a_font->m_def_code_idx;
+  }
   int l, m, u;
+  // codes ranges
+  if ( a_font->m_ranges ) {
+    const packed_code_range_s * v_ranges = a_font->m_ranges;
+    if ( a_code < v_ranges[0].m_code ) {
+      return a_font->m_def_code_idx;
+    }
+    // last range with first code not greater than a_code
+    l = 0;
+    u = a_font->m_ranges_count - 1;
+    while ( l < u ) {
+      m = (l + u + 1) / 2;
+      if ( v_ranges[m].m_code <= a_code ) {
+        l = m;
+      } else {
+        u = m - 1;
+      }
+    }
+    if ( (a_code - v_ranges[l].m_code) < (v_ranges[l + 1].m_index - v_ranges[l].m_index) ) {
+      return v_ranges[l].m_index + (a_code - v_ranges[l].m_code);
+    }
+    return a_font->m_def_code_idx;
+  }
+  // compact symbols table
+  if ( a_font->m_compact ) {
+    return a_font->m_compact->m_codes16
+      ? find_compact_code16( a_font, a_code )
+      : find_compact_code32( a_font, a_code );
+  }
+  // binary search
   l = 0;
   u = a_font->m_symbols_count - 1;
   do {
@@ -28,6 +111,39 @@ static int find_symbol_index( const packed_font_desc_s * a_font, uint32_t a_code
 }
 
 
+// get symbol desc by index, desc of compact symbols table is unpacked into a_buf
+static const packed_symbol_desc_s * load_symbol_desc( const packed_font_desc_s * a_font, int a_idx, packed_symbol_desc_s * a_buf ) {
+  const packed_compact_symbols_s * v_compact = a_font->m_compact;
+  if ( !v_compact ) {
+    return &(a_font->m_symbols[a_idx]);
+  }
+  const uint8_t * v_rec = v_compact->m_metrics + a_idx * (COMPACT_METRICS_SIZE + v_compact->m_pos_bytes);
+  uint32_t v_pos = 0;
+  for ( int i = v_compact->m_pos_bytes - 1; i >= 0; --i ) {
+    v_pos = (v_pos << 8) | v_rec[COMPACT_METRICS_SIZE + i];
+  }
+  a_buf->m_code = v_compact->m_codes16 ? v_compact->m_codes16[a_idx] : v_compact->m_codes32[a_idx];
+  a_buf->m_offset = v_pos >> 1;
+  a_buf->m_nibble = v_pos & 1;
+  a_buf->m_width = v_rec[0];
+  a_buf->m_height = v_rec[1];
+  a_buf->m_x_offset = v_rec[2];
+  a_buf->m_y_offset = v_rec[3];
+  a_buf->m_x_advance = v_rec[4];
+  return a_buf;
+}
+
+
+// get displayed width of symbol by index
+static int get_symbol_x_advance( const packed_font_desc_s * a_font, int a_idx ) {
+  const packed_compact_symbols_s * v_compact = a_font->m_compact;
+  if ( !v_compact ) {
+    return a_font->m_symbols[a_idx].m_x_advance;
+  }
+  return v_compact->m_metrics[a_idx * (COMPACT_METRICS_SIZE + v_compact->m_pos_bytes) + 4];
+}
+
+
 // unpack from R5G6R5 to R8, G8, B8
 static void unpack_color( rgb_unpacked_s * a_dst, uint16_t a_color ) {
   a_dst->r = (a_color >> 8) & 0xF8;
@@ -44,61 +160,133 @@ static uint16_t pack_color( rgb_unpacked_s * a_src ) {
     );
 }
 
-// prepare to display symbol, init a_data structure
-void display_char_init(
-        display_char_s * a_data
-      , uint32_t a_code
-      , const packed_font_desc_s * a_font
-      , uint16_t * a_dst_row
-      , uint16_t a_bgcolor
-      , uint16_t a_fgcolor
-      , uint16_t * a_colors_tbl
-       ) {
-  a_data->m_font = a_font;
-  a_data->m_symbol = &(a_font->m_symbols[find_symbol_index(a_font, a_code)]);
-  a_data->m_bmp_ptr = a_font->m_bmp + a_data->m_symbol->m_offset;
-  a_data->m_curr_nibble = a_data->m_symbol->m_nibble;
-  a_data->m_row = 0;
-  a_data->m_pixbuf = a_dst_row;
-  a_data->m_cols_count = a_data->m_symbol->m_x_advance;
-  a_data->m_counter = 0;
-  a_data->m_curr_color = 0;
-  a_data->m_curr_byte = *a_data->m_bmp_ptr++;
-  a_data->m_last_row = a_data->m_symbol->m_y_offset + a_data->m_symbol->m_height;
-  a_data->m_last_col = a_data->m_symbol->m_x_offset + a_data->m_symbol->m_width;
-  // gen colors table
-  a_data->m_colors = a_colors_tbl;
+// a_x / 7 without division, exact for 0 <= a_x <= 255 * 7
+#define DIV_BY_7(a_x) ((int)(((uint32_t)(a_x) * 9363u) >> 16))
+
+// generate colors table, scale from background to foreground, byte swapped R5G6B5
+static void gen_colors_table( uint16_t * a_colors_tbl, uint16_t a_bgcolor, uint16_t a_fgcolor ) {
   rgb_unpacked_s v_rgb_bg;
   rgb_unpacked_s v_rgb_fg;
   rgb_unpacked_s v_rgb;
   unpack_color( &(v_rgb_bg), a_bgcolor );
   unpack_color( &(v_rgb_fg), a_fgcolor );
   for ( int i = 0; i < 8; ++i ) {
-    v_rgb.r = ((v_rgb_bg.r * (7 - i)) / 7)
-            + ((v_rgb_fg.r * i) / 7)
+    v_rgb.r = DIV_BY_7(v_rgb_bg.r * (7 - i))
+            + DIV_BY_7(v_rgb_fg.r * i)
             ;
-    v_rgb.g = ((v_rgb_bg.g * (7 - i)) / 7)
-            + ((v_rgb_fg.g * i) / 7)
+    v_rgb.g = DIV_BY_7(v_rgb_bg.g * (7 - i))
+            + DIV_BY_7(v_rgb_fg.g * i)
             ;
-    v_rgb.b = ((v_rgb_bg.b * (7 - i)) / 7)
-            + ((v_rgb_fg.b * i) / 7)
+    v_rgb.b = DIV_BY_7(v_rgb_bg.b * (7 - i))
+            + DIV_BY_7(v_rgb_fg.b * i)
             ;
     uint16_t v_c = pack_color( &v_rgb );
-    a_data->m_colors[i] = (v_c >> 8) | (v_c << 8);
+    a_colors_tbl[i] = (v_c >> 8) | (v_c << 8);
+  }
+}
+
+
+// build palette for background and foreground colors
+void display_palette_init( display_palette_s * a_palette, uint16_t a_bgcolor, uint16_t a_fgcolor ) {
+  a_palette->m_bgcolor = a_bgcolor;
+  a_palette->m_fgcolor = a_fgcolor;
+  gen_colors_table( a_palette->m_colors, a_bgcolor, a_fgcolor );
+}
+
+
+// init empty palettes cache
+void display_palette_cache_init( display_palette_cache_s * a_cache ) {
+  a_cache->m_count = 0;
+  a_cache->m_clock = 0;
+}
+
+
+// get palette from cache, build it in place of least recently used one if absent
+const display_palette_s * display_palette_get( display_palette_cache_s * a_cache, uint16_t a_bgcolor, uint16_t a_fgcolor ) {
+  int v_lru = 0;
+  ++a_cache->m_clock;
+  for ( int i = 0; i < a_cache->m_count; ++i ) {
+    if ( a_cache->m_palettes[i].m_bgcolor == a_bgcolor && a_cache->m_palettes[i].m_fgcolor == a_fgcolor ) {
+      a_cache->m_stamps[i] = a_cache->m_clock;
+      return &(a_cache->m_palettes[i]);
+    }
+    if ( a_cache->m_stamps[i] < a_cache->m_stamps[v_lru] ) {
+      v_lru = i;
+    }
+  }
+  if ( a_cache->m_count < DISPLAY_PALETTE_CACHE_SIZE ) {
+    v_lru = a_cache->m_count++;
+  }
+  display_palette_init( &(a_cache->m_palettes[v_lru]), a_bgcolor, a_fgcolor );
+  a_cache->m_stamps[v_lru] = a_cache->m_clock;
+  return &(a_cache->m_palettes[v_lru]);
+}
+
+
+// prepare to display symbol with ready colors table
+static void display_char_init_colors(
+        display_char_s * a_data
+      , uint32_t a_code
+      , const packed_font_desc_s * a_font
+      , uint16_t * a_dst_row
+      , const uint16_t * a_colors_tbl
+       ) {
+  a_data->m_font = a_font;
+  a_data->m_pixbuf = a_dst_row;
+  a_data->m_colors = a_colors_tbl;
+  display_char_init2( a_data, a_code );
+}
+
+
+// prepare to display symbol, init a_data structure
+void display_char_init(
+        display_char_s * a_data
+      , uint32_t a_code
+      , const packed_font_desc_s * a_font
+      , uint16_t * a_dst_row
+      , uint16_t a_bgcolor
+      , uint16_t a_fgcolor
+      , uint16_t * a_colors_tbl
+       ) {
+  gen_colors_table( a_colors_tbl, a_bgcolor, a_fgcolor );
+  display_char_init_colors( a_data, a_code, a_font, a_dst_row, a_colors_tbl );
+}
+
+
+// prepare to display symbol, init a_data structure using prepared palette
+void display_char_init_pal( display_char_s * a_data, uint32_t a_code, const packed_font_desc_s * a_font, uint16_t * a_dst_row, const display_palette_s * a_palette ) {
+  display_char_init_colors( a_data, a_code, a_font, a_dst_row, a_palette->m_colors );
+}
+
+
+// set packed data position, a_pos in nibbles from begin of font packed data (in bits for huffman coded data)
+static void set_packed_pos( display_char_s * a_data, uint32_t a_pos ) {
+  if ( a_data->m_font->m_huffman ) {
+    a_data->m_bit_pos = a_pos;
+    return;
   }
+  a_data->m_bmp_ptr = a_data->m_font->m_bmp + (a_pos >> 1);
+  a_data->m_curr_nibble = (0 != (a_pos & 1));
+  a_data->m_curr_byte = *a_data->m_bmp_ptr++;
 }
 
 
 // prepare to display symbol, using existing font, colors and buffer
 void display_char_init2( display_char_s * a_data, uint32_t a_code ) {
-  a_data->m_symbol = &(a_data->m_font->m_symbols[find_symbol_index(a_data->m_font, a_code)]);
-  a_data->m_bmp_ptr = a_data->m_font->m_bmp + a_data->m_symbol->m_offset;
-  a_data->m_curr_nibble = a_data->m_symbol->m_nibble;
+  int v_idx = find_symbol_index( a_data->m_font, a_code );
+  display_char_init_symbol( a_data, load_symbol_desc( a_data->m_font, v_idx, &(a_data->m_symbol_buf) ), v_idx );
+}
+
+
+// prepare to display resolved symbol, using existing font, colors and buffer
+void display_char_init_symbol( display_char_s * a_data, const packed_symbol_desc_s * a_symbol, int a_symbol_idx ) {
+  a_data->m_symbol_idx = a_symbol_idx;
+  a_data->m_symbol = a_symbol;
+  set_packed_pos( a_data, (a_data->m_symbol->m_offset << 1) | a_data->m_symbol->m_nibble );
   a_data->m_row = 0;
   a_data->m_cols_count = a_data->m_symbol->m_x_advance;
   a_data->m_counter = 0;
   a_data->m_curr_color = 0;
-  a_data->m_curr_byte = *a_data->m_bmp_ptr++;
   a_data->m_last_row = a_data->m_symbol->m_y_offset + a_data->m_symbol->m_height;
   a_data->m_last_col = a_data->m_symbol->m_x_offset + a_data->m_symbol->m_width;
 }
@@ -117,6 +305,9 @@ void display_char_init3( display_char_s * a_data, uint32_t a_code, uint16_t * a_
 }
 
 
+static int next_color_run( display_char_s * a_data, int a_max );
+
+
 // prepare one row pixels buffer, returns 0 (zero), if it was last row
 bool display_char_row( display_char_s * a_data ) {
   uint16_t * a_dst = a_data->m_pixbuf;
@@ -139,6 +330,16 @@ bool display_char_row( display_char_s * a_data ) {
           *a_dst++ = a_data->m_colors[a_data->m_curr_color];
         }
       }
+      // huffman coded pixels
+      if ( a_data->m_font->m_huffman ) {
+        while ( v_col < a_data->m_last_col ) {
+          int v_count = next_color_run( a_data, a_data->m_last_col - v_col );
+          v_col += v_count;
+          for ( ; v_count > 0; --v_count ) {
+            *a_dst++ = a_data->m_colors[a_data->m_curr_color];
+          }
+        }
+      }
       // next pixels
       for ( ; v_col < a_data->m_last_col; ++v_col ) {
         uint8_t v_packed_color;
@@ -180,91 +381,698 @@ bool display_char_row( display_char_s * a_data ) {
 }
 
 
-//
-uint32_t get_next_utf8_code( const char ** a_ptr ) {
-  uint8_t c0 = (uint8_t)*(*a_ptr)++;
-  // one byte
-  if ( 0 == (c0 & 0x80) ) {
-    return c0;
-  }
-  // two bytes
-  if ( 0xC0 == (c0 & 0xE0) ) {
-    uint8_t c1 = (uint8_t)*(*a_ptr)++;
-    if ( 0x80 == (c1 & 0xC0) ) {
-      return ((c0 & 0x1F) << 6) | (c1 & 0x3F);
+// get next nibble from symbol packed data
+static uint8_t next_packed_color( display_char_s * a_data ) {
+  uint8_t v_packed_color;
+  if ( a_data->m_curr_nibble ) {
+    // low nibble
+    v_packed_color = a_data->m_curr_byte & 0x0F;
+    a_data->m_curr_nibble = false;
+    a_data->m_curr_byte = *a_data->m_bmp_ptr++;
+  } else {
+    // high nibble
+    v_packed_color = (a_data->m_curr_byte >> 4) & 0x0F;
+    a_data->m_curr_nibble = true;
+  }
+  return v_packed_color;
+}
+
+
+// get next bits of huffman coded data, MSB first, at least 17 bits are valid
+static uint32_t peek_packed_bits( const display_char_s * a_data ) {
+  const uint8_t * v_ptr = a_data->m_font->m_bmp + (a_data->m_bit_pos >> 3);
+  uint32_t v_bits = ((uint32_t)v_ptr[0] << 24) | ((uint32_t)v_ptr[1] << 16) | ((uint32_t)v_ptr[2] << 8);
+  return v_bits << (a_data->m_bit_pos & 7);
+}
+
+
+// get next huffman coded symbol
+static int next_huffman_symbol( display_char_s * a_data ) {
+  const packed_huffman_s * v_huffman = a_data->m_font->m_huffman;
+  uint32_t v_bits = peek_packed_bits( a_data );
+  uint16_t v_entry = v_huffman->m_lookup[v_bits >> (32 - HUFFMAN_LOOKUP_BITS)];
+  if ( 0 != v_entry ) {
+    a_data->m_bit_pos += v_entry >> 8;
+    return v_entry & 0xFF;
+  }
+  // long code, canonical decoding bit by bit
+  int v_code = 0;
+  int v_first = 0;
+  int v_index = 0;
+  for ( int v_len = 1; v_len <= HUFFMAN_MAX_BITS; ++v_len ) {
+    v_code |= (v_bits >> (32 - v_len)) & 1;
+    int v_count = v_huffman->m_counts[v_len];
+    if ( v_code - v_first < v_count ) {
+      a_data->m_bit_pos += v_len;
+      return v_huffman->m_symbols[v_index + v_code - v_first];
+    }
+    v_index += v_count;
+    v_first = (v_first + v_count) << 1;
+    v_code <<= 1;
+  }
+  // broken data
+  return 0;
+}
+
+
+// get next run of current color within symbol bitmap row, up to a_max pixels
+static int next_color_run( display_char_s * a_data, int a_max ) {
+  if ( 0 == a_data->m_counter ) {
+    int v_symbol = a_data->m_font->m_huffman ? next_huffman_symbol( a_data ) : next_packed_color( a_data );
+    if ( v_symbol < HUFFMAN_SYMBOL_RUN ) {
+      a_data->m_curr_color = v_symbol;
+      return 1;
+    }
+    if ( v_symbol < HUFFMAN_SYMBOL_LONG_RUN ) {
+      a_data->m_counter = v_symbol - (HUFFMAN_SYMBOL_RUN - 1);
     } else {
-      return 0;
+      // long run, extra bits follow
+      int v_extra_bits = 3 + v_symbol - HUFFMAN_SYMBOL_LONG_RUN;
+      a_data->m_counter = (8 << (v_symbol - HUFFMAN_SYMBOL_LONG_RUN)) + 1 + (int)(peek_packed_bits( a_data ) >> (32 - v_extra_bits));
+      a_data->m_bit_pos += v_extra_bits;
     }
   }
-  // three bytes
-  if ( 0xE0 == (c0 & 0xF0) ) {
-    uint8_t c1 = (uint8_t)*(*a_ptr)++;
-    if ( 0x80 == (c1 & 0xC0) ) {
-      uint8_t c2 = (uint8_t)*(*a_ptr)++;
-      if ( 0x80 == (c2 & 0xC0) ) {
-        return ((c0 & 0x1F) << 12) | ((c1 & 0x3F) << 6) | (c2 & 0x3F);
-      } else {
-        return 0;
+  int v_count = a_data->m_counter < a_max ? a_data->m_counter : a_max;
+  a_data->m_counter -= v_count;
+  return v_count;
+}
+
+
+// get next run of current color within symbol bitmap row, for renderers into other outputs
+int display_char_next_run( display_char_s * a_data, int a_max ) {
+  return next_color_run( a_data, a_max );
+}
+
+
+// consume packed data of one symbol bitmap row without writing pixels
+static void skip_symbol_row( display_char_s * a_data ) {
+  for ( int v_col = a_data->m_symbol->m_x_offset; v_col < a_data->m_last_col; ) {
+    v_col += next_color_run( a_data, a_data->m_last_col - v_col );
+  }
+}
+
+
+// set row to display next, uses font rows index if exists, else skips hidden rows
+void display_char_seek_row( display_char_s * a_data, int a_row ) {
+  const packed_symbol_desc_s * v_symbol = a_data->m_symbol;
+  // bitmap rows consumed before and after seek
+  int v_curr = a_data->m_row - v_symbol->m_y_offset;
+  int v_next = a_row - v_symbol->m_y_offset;
+  if ( v_curr < 0 ) {
+    v_curr = 0;
+  }
+  if ( v_next < 0 ) {
+    v_next = 0;
+  }
+  if ( v_curr > v_symbol->m_height ) {
+    v_curr = v_symbol->m_height;
+  }
+  if ( v_next >= v_symbol->m_height ) {
+    // no more bitmap rows to display, packed data position doesn't matter,
+    // next seek back will restore it
+    v_next = v_curr;
+  }
+  if ( v_next != v_curr ) {
+    if ( v_next > 0 && v_next < v_symbol->m_height && a_data->m_font->m_rows ) {
+      // restore decoder state from rows index
+      uint32_t v_entry = a_data->m_font->m_rows[a_data->m_font->m_rows_first[a_data->m_symbol_idx] + v_next];
+      set_packed_pos( a_data, ROWS_INDEX_POS(v_entry) );
+      a_data->m_counter = ROWS_INDEX_COUNTER(v_entry);
+      a_data->m_curr_color = ROWS_INDEX_COLOR(v_entry);
+    } else {
+      if ( v_next < v_curr ) {
+        // rewind to symbol begin
+        set_packed_pos( a_data, (v_symbol->m_offset << 1) | v_symbol->m_nibble );
+        a_data->m_counter = 0;
+        a_data->m_curr_color = 0;
+        v_curr = 0;
+      }
+      for ( ; v_curr < v_next; ++v_curr ) {
+        skip_symbol_row( a_data );
+      }
+    }
+  }
+  a_data->m_row = a_row;
+}
+
+
+// prepare one row of shades, from 0 (background) to 7 (foreground), returns true, if it was last row
+bool display_char_row_shades( display_char_s * a_data, uint8_t * a_dst ) {
+  int v_col = 0;
+  if ( a_data->m_row >= a_data->m_symbol->m_y_offset && a_data->m_row < a_data->m_last_row ) {
+    // x offset
+    for ( ; v_col < a_data->m_symbol->m_x_offset; ++v_col ) {
+      *a_dst++ = 0;
+    }
+    // symbol bitmap row
+    while ( v_col < a_data->m_last_col ) {
+      int v_count = next_color_run( a_data, a_data->m_last_col - v_col );
+      v_col += v_count;
+      for ( ; v_count > 0; --v_count ) {
+        *a_dst++ = a_data->m_curr_color;
       }
+    }
+  }
+  // background up to x_advance
+  for ( ; v_col < a_data->m_symbol->m_x_advance; ++v_col ) {
+    *a_dst++ = 0;
+  }
+  //
+  return ++a_data->m_row >= a_data->m_font->m_row_height;
+}
+
+
+// prepare to display one text line with ready colors table
+static void display_line_init_colors(
+        display_line_s * a_data
+      , const char * a_str
+      , const packed_font_desc_s * a_font
+      , uint16_t * a_dst_row
+      , int a_width
+      , display_char_s * a_chars
+      , int a_chars_max
+      , const uint16_t * a_colors_tbl
+       ) {
+  a_data->m_font = a_font;
+  a_data->m_chars = a_chars;
+  a_data->m_chars_count = 0;
+  a_data->m_pixbuf = a_dst_row;
+  a_data->m_width = a_width;
+  a_data->m_text_width = 0;
+  a_data->m_row = 0;
+  a_data->m_next = 0;
+  a_data->m_bgcolor = a_colors_tbl[0];
+  // place symbols of line (up to LF) while they fit into row
+  line_codes_s v_codes;
+  line_codes_init( &v_codes, a_str );
+  uint32_t v_code;
+  while ( line_codes_next( &v_codes, &v_code ) ) {
+    if ( a_data->m_chars_count >= a_chars_max ) {
+      break;
+    }
+    display_char_s * v_char = &(a_chars[a_data->m_chars_count]);
+    v_char->m_font = a_font;
+    v_char->m_colors = a_colors_tbl;
+    display_char_init2( v_char, v_code );
+    if ( (a_data->m_text_width + v_char->m_cols_count) > a_width ) {
+      break;
+    }
+    v_char->m_pixbuf = a_dst_row + a_data->m_text_width;
+    a_data->m_text_width += v_char->m_cols_count;
+    ++a_data->m_chars_count;
+  }
+  a_data->m_next = line_codes_rest( &v_codes );
+}
+
+
+// prepare one row of visible pixels of symbol place, runs before and after them are consumed only
+bool display_char_row_clip( display_char_s * a_data, int a_first, int a_count ) {
+  const packed_symbol_desc_s * v_symbol = a_data->m_symbol;
+  const uint16_t * v_colors = a_data->m_colors;
+  uint16_t * v_dst = a_data->m_pixbuf;
+  int v_end = a_first + a_count;
+  // next col to write
+  int v_col = a_first;
+  if ( a_data->m_row >= v_symbol->m_y_offset && a_data->m_row < a_data->m_last_row ) {
+    // x offset
+    for ( ; v_col < v_symbol->m_x_offset && v_col < v_end; ++v_col ) {
+      *v_dst++ = v_colors[0];
+    }
+    // symbol bitmap row
+    for ( int v_run = v_symbol->m_x_offset; v_run < a_data->m_last_col; ) {
+      v_run += next_color_run( a_data, a_data->m_last_col - v_run );
+      uint16_t v_color = v_colors[a_data->m_curr_color];
+      for ( ; v_col < v_run && v_col < v_end; ++v_col ) {
+        *v_dst++ = v_color;
+      }
+    }
+  }
+  // background up to end of visible pixels
+  for ( ; v_col < v_end; ++v_col ) {
+    *v_dst++ = v_colors[0];
+  }
+  //
+  return ++a_data->m_row >= a_data->m_font->m_row_height;
+}
+
+
+// prepare to display one text line, init a_data structure and decoders for each symbol
+void display_line_init(
+        display_line_s * a_data
+      , const char * a_str
+      , const packed_font_desc_s * a_font
+      , uint16_t * a_dst_row
+      , int a_width
+      , display_char_s * a_chars
+      , int a_chars_max
+      , uint16_t a_bgcolor
+      , uint16_t a_fgcolor
+      , uint16_t * a_colors_tbl
+       ) {
+  gen_colors_table( a_colors_tbl, a_bgcolor, a_fgcolor );
+  display_line_init_colors( a_data, a_str, a_font, a_dst_row, a_width, a_chars, a_chars_max, a_colors_tbl );
+}
+
+
+// prepare to display one text line using prepared palette
+void display_line_init_pal( display_line_s * a_data, const char * a_str, const packed_font_desc_s * a_font, uint16_t * a_dst_row, int a_width, display_char_s * a_chars, int a_chars_max, const display_palette_s * a_palette ) {
+  display_line_init_colors( a_data, a_str, a_font, a_dst_row, a_width, a_chars, a_chars_max, a_palette->m_colors );
+}
+
+
+// prepare one full-width row pixels buffer, returns true, if it was last row
+bool display_line_row( display_line_s * a_data ) {
+  // all symbols decoders in one pass, each writes its own part of row
+  for ( int i = 0; i < a_data->m_chars_count; ++i ) {
+    display_char_s * v_char = &(a_data->m_chars[i]);
+    if ( (v_char->m_pixbuf - a_data->m_pixbuf) + v_char->m_last_col <= a_data->m_width ) {
+      display_char_row( v_char );
     } else {
-      return 0;
+      // symbol pixels beyond x_advance would get out of row
+      display_char_row_clip( v_char, 0, v_char->m_cols_count );
     }
   }
-  // four bytes
-  if ( 0xF0 == (c0 & 0xF8) ) {
-    uint8_t c1 = (uint8_t)*(*a_ptr)++;
-    if ( 0x80 == (c1 & 0xC0) ) {
-      uint8_t c2 = (uint8_t)*(*a_ptr)++;
-      if ( 0x80 == (c2 & 0xC0) ) {
-        uint8_t c3 = (uint8_t)*(*a_ptr)++;
-        if ( 0x80 == (c3 & 0xC0) ) {
-          return ((c0 & 0x1F) << 12) | ((c1 & 0x3F) << 6) | (c2 & 0x3F);
-        } else {
-          return 0;
-        }
-      } else {
-        return 0;
+  // background color up to row width
+  uint16_t * v_dst = a_data->m_pixbuf + a_data->m_text_width;
+  for ( int i = a_data->m_text_width; i < a_data->m_width; ++i ) {
+    *v_dst++ = a_data->m_bgcolor;
+  }
+  //
+  return ++a_data->m_row >= a_data->m_font->m_row_height;
+}
+
+
+// set row to display next for all symbols of line
+void display_line_seek_row( display_line_s * a_data, int a_row ) {
+  for ( int i = 0; i < a_data->m_chars_count; ++i ) {
+    display_char_seek_row( &(a_data->m_chars[i]), a_row );
+  }
+  a_data->m_row = a_row;
+}
+
+
+// prepare to display scrolled text line, hidden symbols are measured only
+void display_line_init_clip(
+        display_line_clip_s * a_data
+      , const char * a_str
+      , const packed_font_desc_s * a_font
+      , uint16_t * a_dst_row
+      , int a_width
+      , int a_offset
+      , display_char_s * a_chars
+      , int a_chars_max
+      , const display_palette_s * a_palette
+       ) {
+  display_line_s * v_line = &(a_data->m_line);
+  v_line->m_font = a_font;
+  v_line->m_chars = a_chars;
+  v_line->m_chars_count = 0;
+  v_line->m_pixbuf = a_dst_row;
+  v_line->m_width = a_width;
+  v_line->m_row = 0;
+  v_line->m_next = 0;
+  v_line->m_bgcolor = a_palette->m_colors[0];
+  a_data->m_lead = a_offset >= 0 ? 0 : (-a_offset < a_width ? -a_offset : a_width);
+  a_data->m_first_skip = 0;
+  a_data->m_last_count = 0;
+  v_line->m_text_width = a_data->m_lead;
+  // row pixel of next symbol
+  int v_pen = -a_offset;
+  line_codes_s v_codes;
+  line_codes_init( &v_codes, a_str );
+  uint32_t v_code;
+  while ( line_codes_next( &v_codes, &v_code ) ) {
+    if ( v_pen >= a_width || v_line->m_chars_count >= a_chars_max ) {
+      break;
+    }
+    int v_idx = find_symbol_index( a_font, v_code );
+    int v_advance = get_symbol_x_advance( a_font, v_idx );
+    if ( v_pen + v_advance > 0 && v_advance > 0 ) {
+      // visible symbol
+      display_char_s * v_char = &(a_chars[v_line->m_chars_count]);
+      int v_skip = v_pen < 0 ? -v_pen : 0;
+      int v_visible_end = v_pen + v_advance < a_width ? v_pen + v_advance : a_width;
+      v_char->m_font = a_font;
+      v_char->m_colors = a_palette->m_colors;
+      v_char->m_pixbuf = a_dst_row + v_pen + v_skip;
+      display_char_init_symbol( v_char, load_symbol_desc( a_font, v_idx, &(v_char->m_symbol_buf) ), v_idx );
+      if ( 0 == v_line->m_chars_count ) {
+        a_data->m_first_skip = v_skip;
       }
+      a_data->m_last_count = v_visible_end - v_pen - v_skip;
+      v_line->m_text_width = v_visible_end;
+      ++v_line->m_chars_count;
+    }
+    v_pen += v_advance;
+  }
+  v_line->m_next = line_codes_rest( &v_codes );
+}
+
+
+// prepare one full-width row of clipped line, partly visible symbols are clipped while decoded
+bool display_line_row_clip( display_line_clip_s * a_data ) {
+  display_line_s * v_line = &(a_data->m_line);
+  uint16_t * v_dst = v_line->m_pixbuf;
+  for ( int i = 0; i < a_data->m_lead; ++i ) {
+    *v_dst++ = v_line->m_bgcolor;
+  }
+  int v_last = v_line->m_chars_count - 1;
+  for ( int i = 0; i <= v_last; ++i ) {
+    display_char_s * v_char = &(v_line->m_chars[i]);
+    int v_first = 0 == i ? a_data->m_first_skip : 0;
+    if ( i < v_last && 0 == v_first && v_char->m_last_col <= v_char->m_cols_count ) {
+      // whole symbol is visible and its pixels are within its place
+      display_char_row( v_char );
     } else {
-      return 0;
+      display_char_row_clip( v_char, v_first, i < v_last ? v_char->m_cols_count - v_first : a_data->m_last_count );
+    }
+  }
+  // background color up to row width
+  v_dst = v_line->m_pixbuf + v_line->m_text_width;
+  for ( int i = v_line->m_text_width; i < v_line->m_width; ++i ) {
+    *v_dst++ = v_line->m_bgcolor;
+  }
+  //
+  return ++v_line->m_row >= v_line->m_font->m_row_height;
+}
+
+
+// pointer of pixel (a_x, a_y) of a_width x a_height pixels image within its tile rotated by a_rotation,
+// steps to next column and next row of image
+static uint16_t * rotated_pixel( int a_rotation, uint16_t * a_dst, ptrdiff_t a_stride, int a_width, int a_height, int a_x, int a_y, ptrdiff_t * a_col_step, ptrdiff_t * a_row_step ) {
+  switch ( a_rotation ) {
+    case DISPLAY_ROTATE_90:
+      *a_col_step = a_stride;
+      *a_row_step = -1;
+      return a_dst + a_x * a_stride + (a_height - 1 - a_y);
+    case DISPLAY_ROTATE_180:
+      *a_col_step = -1;
+      *a_row_step = -a_stride;
+      return a_dst + (a_height - 1 - a_y) * a_stride + (a_width - 1 - a_x);
+    case DISPLAY_ROTATE_270:
+      *a_col_step = -a_stride;
+      *a_row_step = 1;
+      return a_dst + (a_width - 1 - a_x) * a_stride + a_y;
+    default:
+      *a_col_step = 1;
+      *a_row_step = a_stride;
+      return a_dst + a_y * a_stride + a_x;
+  }
+}
+
+
+// display rest rows of symbol, a_dst - pixel of current row and col 0, pixels are written by steps
+static void display_char_steps( display_char_s * a_data, uint16_t * a_dst, ptrdiff_t a_col_step, ptrdiff_t a_row_step ) {
+  const packed_symbol_desc_s * v_symbol = a_data->m_symbol;
+  const uint16_t * v_colors = a_data->m_colors;
+  int v_width = a_data->m_cols_count;
+  for ( ; a_data->m_row < a_data->m_font->m_row_height; ++a_data->m_row, a_dst += a_row_step ) {
+    uint16_t * v_dst = a_dst;
+    int v_col = 0;
+    if ( a_data->m_row >= v_symbol->m_y_offset && a_data->m_row < a_data->m_last_row ) {
+      // x offset
+      for ( ; v_col < v_symbol->m_x_offset && v_col < v_width; ++v_col, v_dst += a_col_step ) {
+        *v_dst = v_colors[0];
+      }
+      // symbol bitmap row, decoded up to its end, written up to x_advance
+      for ( v_col = v_symbol->m_x_offset; v_col < a_data->m_last_col; ) {
+        int v_end = v_col + next_color_run( a_data, a_data->m_last_col - v_col );
+        int v_visible = v_end < v_width ? v_end : v_width;
+        uint16_t v_color = v_colors[a_data->m_curr_color];
+        for ( ; v_col < v_visible; ++v_col, v_dst += a_col_step ) {
+          *v_dst = v_color;
+        }
+        v_col = v_end;
+      }
+    }
+    // background up to x_advance
+    for ( ; v_col < v_width; ++v_col, v_dst += a_col_step ) {
+      *v_dst = v_colors[0];
+    }
+  }
+}
+
+
+// display rest rows of symbol rotated into tile
+void display_char_rotated( display_char_s * a_data, int a_rotation, uint16_t * a_dst, int a_stride ) {
+  ptrdiff_t v_col_step;
+  ptrdiff_t v_row_step;
+  if ( a_data->m_cols_count <= 0 ) {
+    a_data->m_row = a_data->m_font->m_row_height;
+    return;
+  }
+  uint16_t * v_dst = rotated_pixel( a_rotation, a_dst, a_stride, a_data->m_cols_count, a_data->m_font->m_row_height, 0, a_data->m_row, &v_col_step, &v_row_step );
+  display_char_steps( a_data, v_dst, v_col_step, v_row_step );
+}
+
+
+// display rest rows of line rotated into tile, symbol by symbol
+void display_line_rotated( display_line_s * a_data, int a_rotation, uint16_t * a_dst, int a_stride ) {
+  ptrdiff_t v_col_step;
+  ptrdiff_t v_row_step;
+  int v_height = a_data->m_font->m_row_height;
+  int v_x = 0;
+  for ( int i = 0; i < a_data->m_chars_count; ++i ) {
+    display_char_s * v_char = &(a_data->m_chars[i]);
+    if ( v_char->m_cols_count > 0 ) {
+      uint16_t * v_dst = rotated_pixel( a_rotation, a_dst, a_stride, a_data->m_width, v_height, v_x, v_char->m_row, &v_col_step, &v_row_step );
+      display_char_steps( v_char, v_dst, v_col_step, v_row_step );
+    }
+    v_x += v_char->m_cols_count;
+  }
+  // background color up to line width
+  if ( a_data->m_text_width < a_data->m_width ) {
+    for ( int y = a_data->m_row; y < v_height; ++y ) {
+      uint16_t * v_dst = rotated_pixel( a_rotation, a_dst, a_stride, a_data->m_width, v_height, a_data->m_text_width, y, &v_col_step, &v_row_step );
+      for ( int x = a_data->m_text_width; x < a_data->m_width; ++x, v_dst += v_col_step ) {
+        *v_dst = a_data->m_bgcolor;
+      }
+    }
+  }
+  a_data->m_row = v_height;
+}
+
+
+// decode one utf-8 sequence of a_avail bytes at most, bytes are read up to first bad one,
+// returns sequence length, 0 for invalid sequence, -1 for sequence cut by a_avail;
+// ranges of second byte exclude overlong forms, surrogates and codes above 0x10FFFF
+static int decode_utf8_sequence( const uint8_t * a_src, size_t a_avail, uint32_t * a_code ) {
+  uint8_t c0 = a_src[0];
+  uint8_t v_lo = 0x80;
+  uint8_t v_hi = 0xBF;
+  int v_len;
+  uint32_t v_code;
+  if ( c0 < 0x80 ) {
+    *a_code = c0;
+    return 1;
+  }
+  if ( c0 >= 0xC2 && c0 <= 0xDF ) {
+    v_len = 2;
+    v_code = c0 & 0x1F;
+  } else if ( c0 >= 0xE0 && c0 <= 0xEF ) {
+    v_len = 3;
+    v_code = c0 & 0x0F;
+    if ( 0xE0 == c0 ) {
+      v_lo = 0xA0;
+    } else if ( 0xED == c0 ) {
+      v_hi = 0x9F;
+    }
+  } else if ( c0 >= 0xF0 && c0 <= 0xF4 ) {
+    v_len = 4;
+    v_code = c0 & 0x07;
+    if ( 0xF0 == c0 ) {
+      v_lo = 0x90;
+    } else if ( 0xF4 == c0 ) {
+      v_hi = 0x8F;
     }
   } else {
+    // continuation byte, overlong lead 0xC0, 0xC1 or lead above 0xF4
     return 0;
   }
+  for ( int i = 1; i < v_len; ++i ) {
+    if ( (size_t)i >= a_avail ) {
+      return -1;
+    }
+    if ( a_src[i] < v_lo || a_src[i] > v_hi ) {
+      return 0;
+    }
+    v_code = (v_code << 6) | (a_src[i] & 0x3F);
+    v_lo = 0x80;
+    v_hi = 0xBF;
+  }
+  *a_code = v_code;
+  return v_len;
+}
+
+
+// get next symbol (uni)code, 0 at end of string or invalid sequence
+uint32_t get_next_utf8_code( const char ** a_ptr ) {
+  uint32_t v_code;
+  // zero byte isn't continuation, so bytes after end of string aren't read
+  int v_len = decode_utf8_sequence( (const uint8_t *)*a_ptr, 4, &v_code );
+  if ( v_len <= 0 ) {
+    ++(*a_ptr);
+    return 0;
+  }
+  *a_ptr += v_len;
+  return v_code;
+}
+
+
+// decode utf-8 text into codes, ASCII runs are converted by blocks
+int utf8_decode( const char ** a_ptr, const char * a_end, uint32_t * a_codes, int a_codes_max, int * a_error ) {
+  const uint8_t * v_src = (const uint8_t *)*a_ptr;
+  const uint8_t * v_end = (const uint8_t *)a_end;
+  int v_count = 0;
+  *a_error = UTF8_OK;
+  while ( v_src < v_end && v_count < a_codes_max ) {
+#if defined(__SSE2__)
+    // 16 ASCII bytes at once
+    while ( v_end - v_src >= 16 && a_codes_max - v_count >= 16 ) {
+      const __m128i v_zero = _mm_setzero_si128();
+      __m128i v_bytes = _mm_loadu_si128( (const __m128i *)v_src );
+      int v_mask = _mm_movemask_epi8( v_bytes );
+      if ( 0 != v_mask ) {
+        // ASCII prefix
+        for ( int i = __builtin_ctz( v_mask ); i > 0; --i ) {
+          a_codes[v_count++] = *v_src++;
+        }
+        break;
+      }
+      __m128i v_lo = _mm_unpacklo_epi8( v_bytes, v_zero );
+      __m128i v_hi = _mm_unpackhi_epi8( v_bytes, v_zero );
+      _mm_storeu_si128( (__m128i *)(a_codes + v_count), _mm_unpacklo_epi16( v_lo, v_zero ) );
+      _mm_storeu_si128( (__m128i *)(a_codes + v_count + 4), _mm_unpackhi_epi16( v_lo, v_zero ) );
+      _mm_storeu_si128( (__m128i *)(a_codes + v_count + 8), _mm_unpacklo_epi16( v_hi, v_zero ) );
+      _mm_storeu_si128( (__m128i *)(a_codes + v_count + 12), _mm_unpackhi_epi16( v_hi, v_zero ) );
+      v_src += 16;
+      v_count += 16;
+    }
+#else
+    // 4 ASCII bytes at once
+    while ( v_end - v_src >= 4 && a_codes_max - v_count >= 4 ) {
+      uint32_t v_word;
+      memcpy( &v_word, v_src, sizeof(v_word) );
+      if ( 0 != (v_word & 0x80808080u) ) {
+        break;
+      }
+      a_codes[v_count] = v_src[0];
+      a_codes[v_count + 1] = v_src[1];
+      a_codes[v_count + 2] = v_src[2];
+      a_codes[v_count + 3] = v_src[3];
+      v_src += 4;
+      v_count += 4;
+    }
+#endif
+    if ( v_src >= v_end || v_count >= a_codes_max ) {
+      break;
+    }
+    if ( *v_src < 0x80 ) {
+      a_codes[v_count++] = *v_src++;
+      continue;
+    }
+    int v_len = decode_utf8_sequence( v_src, (size_t)(v_end - v_src), &(a_codes[v_count]) );
+    if ( v_len <= 0 ) {
+      // stop at bad sequence
+      *a_error = 0 == v_len ? UTF8_INVALID : UTF8_TRUNCATED;
+      break;
+    }
+    v_src += v_len;
+    ++v_count;
+  }
+  *a_ptr = (const char *)v_src;
+  return v_count;
+}
+
+
+// start walking codes of text line
+void line_codes_init( line_codes_s * a_codes, const char * a_str ) {
+  const char * v_end = strchr( a_str, '\n' );
+  a_codes->m_str = a_str;
+  a_codes->m_end = v_end ? v_end : a_str + strlen( a_str );
+  a_codes->m_next = v_end ? v_end + 1 : 0;
+  a_codes->m_count = 0;
+  a_codes->m_pos = 0;
+  a_codes->m_error = UTF8_OK;
 }
 
 
-//
+// get next code of line, next batch is decoded when current one is used up
+bool line_codes_next( line_codes_s * a_codes, uint32_t * a_code ) {
+  for ( ;; ) {
+    while ( a_codes->m_pos < a_codes->m_count ) {
+      uint32_t v_code = a_codes->m_codes[a_codes->m_pos++];
+      if ( '\r' != v_code ) {
+        *a_code = v_code;
+        return true;
+      }
+    }
+    if ( a_codes->m_str >= a_codes->m_end || UTF8_OK != a_codes->m_error ) {
+      return false;
+    }
+    a_codes->m_count = utf8_decode( &(a_codes->m_str), a_codes->m_end, a_codes->m_codes, UTF8_DECODE_BATCH, &(a_codes->m_error) );
+    a_codes->m_pos = 0;
+  }
+}
+
+
+// next text line, invalid sequence ends text
+const char * line_codes_rest( const line_codes_s * a_codes ) {
+  return UTF8_OK == a_codes->m_error ? a_codes->m_next : 0;
+}
+
+
+// get symbol desc by code, default symbol desc if code not found,
+// for fonts with compact symbols table desc is unpacked into a_buf
+const packed_symbol_desc_s * get_symbol_desc_buf( const packed_font_desc_s * a_font, uint32_t a_code, packed_symbol_desc_s * a_buf ) {
+  return load_symbol_desc( a_font, find_symbol_index(a_font, a_code), a_buf );
+}
+
+
+// get symbol desc by code, default symbol desc if code not found
+const packed_symbol_desc_s * get_symbol_desc( const packed_font_desc_s * a_font, uint32_t a_code ) {
+  return &(a_font->m_symbols[find_symbol_index(a_font, a_code)]);
+}
+
+
+// get rectangle size for text, codes are decoded by batches
 void get_text_extent( const packed_font_desc_s * a_font, const char * a_str, int * a_width, int * a_height ) {
+  uint32_t v_codes[UTF8_DECODE_BATCH];
+  const char * v_end = a_str + strlen( a_str );
   int v_width = 0;
   int v_height = 0;
   int v_max_width = 0;
   int v_height_add = a_font->m_row_height;
   int v_idx;
-  // scan all characters
-  for ( uint32_t c = get_next_utf8_code( &a_str ); 0 != c; c = get_next_utf8_code( &a_str ) ) {
-    if ( '\r' == c ) {
-      // CR
-      v_width = 0;
-      continue;
-    }
-    if ( '\n' == c ) {
-      // LF unix style
-      v_height_add += a_font->m_row_height;
-      v_width = 0;
-      continue;
-    }
-    // increase height at first symbol
-    if ( 0 == v_width ) {
-      v_height += v_height_add;
-      v_height_add = 0;
-    }
-    //
-    v_idx = find_symbol_index( a_font, c );
-    v_width += a_font->m_symbols[v_idx].m_x_advance;
-    //
-    if ( v_width > v_max_width ) {
-      v_max_width = v_width;
+  int v_error = UTF8_OK;
+  // scan all characters, up to invalid sequence
+  while ( a_str < v_end && UTF8_OK == v_error ) {
+    int v_count = utf8_decode( &a_str, v_end, v_codes, UTF8_DECODE_BATCH, &v_error );
+    for ( int i = 0; i < v_count; ++i ) {
+      uint32_t c = v_codes[i];
+      if ( '\r' == c ) {
+        // CR
+        v_width = 0;
+        continue;
+      }
+      if ( '\n' == c ) {
+        // LF unix style
+        v_height_add += a_font->m_row_height;
+        v_width = 0;
+        continue;
+      }
+      // increase height at first symbol
+      if ( 0 == v_width ) {
+        v_height += v_height_add;
+        v_height_add = 0;
+      }
+      //
+      v_idx = find_symbol_index( a_font, c );
+      v_width += get_symbol_x_advance( a_font, v_idx );
+      //
+      if ( v_width > v_max_width ) {
+        v_max_width = v_width;
+      }
     }
   }
   // result
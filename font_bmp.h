@@ -8,7 +8,8 @@
 extern "C" {
 #endif
 
-// packed symbol description
+// packed symbol description,
+// for huffman coded fonts (m_offset << 1) | m_nibble is position in bits of symbol's packed data
 typedef struct {
   uint32_t m_code;       // code
   uint32_t m_offset: 31; // index of first byte symbol's packed data
@@ -21,13 +22,75 @@ typedef struct {
 } packed_symbol_desc_s;
 
 
+// rows index entry, decoder state at start of symbol bitmap row:
+// position in nibbles from begin of packed data, repeat counter, current color
+#define ROWS_INDEX_ENTRY(pos,counter,color) ((uint32_t)(((pos) << 7) | ((counter) << 3) | (color)))
+#define ROWS_INDEX_POS(entry)     ((entry) >> 7)
+#define ROWS_INDEX_COUNTER(entry) (((entry) >> 3) & 0x0F)
+#define ROWS_INDEX_COLOR(entry)   ((entry) & 0x07)
+// positions are less, packed data up to 16 MiB
+#define ROWS_INDEX_POS_LIMIT      (1u << 25)
+
+
+// contiguous codes range, codes from m_code are symbols from m_index up to m_index of next range
+typedef struct {
+  uint32_t m_code;                  // first code of range
+  uint32_t m_index;                 // index of first symbol of range within m_symbols
+} packed_code_range_s;
+
+
+#define DIRECT_CODES_COUNT  256
+#define DIRECT_NO_SYMBOL    0xFFFF
+
+
+// huffman coded packed data: symbols 0..7 set color, symbols 8..15 repeat color 1..8 times,
+// long run symbol 16 + n repeats color (8 << n) + 1 + extra times, extra (3 + n bits) follows symbol code,
+// codes and extra bits are MSB first, symbol data starts from color 0 as nibbles do
+#define HUFFMAN_MAX_BITS        16
+#define HUFFMAN_LOOKUP_BITS     8
+#define HUFFMAN_SYMBOL_RUN      8
+#define HUFFMAN_SYMBOL_LONG_RUN 16
+#define HUFFMAN_LONG_RUNS       13
+#define HUFFMAN_SYMBOLS         (HUFFMAN_SYMBOL_LONG_RUN + HUFFMAN_LONG_RUNS)
+#define HUFFMAN_LOOKUP_ENTRY(len,symbol) ((uint16_t)(((len) << 8) | (symbol)))
+
+// canonical huffman code of font
+typedef struct {
+  const uint16_t * m_lookup;        // by next HUFFMAN_LOOKUP_BITS bits: HUFFMAN_LOOKUP_ENTRY, 0 for longer codes
+  const uint16_t * m_counts;        // codes count of each length, 0..HUFFMAN_MAX_BITS
+  const uint8_t * m_symbols;        // symbols in codes order
+} packed_huffman_s;
+
+
+// compact symbols table, codes for search are apart from metrics (structure of arrays),
+// one of codes arrays is set, codes are sorted
+#define COMPACT_METRICS_SIZE  5     // width, height, x_offset, y_offset, x_advance bytes of metrics record
+
+typedef struct {
+  const uint16_t * m_codes16;       // codes, if all codes are less than 0x10000
+  const uint32_t * m_codes32;       // codes, else
+  const uint8_t * m_metrics;        // records of COMPACT_METRICS_SIZE + m_pos_bytes bytes for each symbol,
+                                    // metrics and little endian position of symbol's packed data
+                                    // in nibbles (in bits for huffman coded data)
+  int m_pos_bytes;                  // 1..4, bytes of position
+} packed_compact_symbols_s;
+
+
 // packed font description
 typedef struct {
   const uint8_t * m_bmp;            // font packed data ptr
   int m_symbols_count;              // total symbols
   int m_row_height;                 // text row height
   uint32_t m_def_code_idx;          // default symbol index, if symbol code not found
-  const packed_symbol_desc_s * m_symbols; // descriptions of symbols ptr
+  const packed_symbol_desc_s * m_symbols; // descriptions of symbols ptr, 0 if m_compact is used
+  const uint32_t * m_rows_first;    // optional rows index, index of symbol first row within m_rows
+  const uint32_t * m_rows;          // optional rows index, entries for each symbol bitmap row
+  const uint16_t * m_direct;        // optional symbol index for codes less than DIRECT_CODES_COUNT
+  const packed_code_range_s * m_ranges; // optional codes ranges, one more entry after last range
+  int m_ranges_count;               // codes ranges count
+  uint32_t m_bmp_size;              // font packed data size in bytes, 0 if unknown
+  const packed_huffman_s * m_huffman; // optional, packed data is huffman coded instead of nibbles
+  const packed_compact_symbols_s * m_compact; // optional, compact symbols table instead of m_symbols
 } packed_font_desc_s;
 
 
@@ -37,7 +100,55 @@ typedef struct {
   int b;
 } rgb_unpacked_s;
 
-// display char structure
+// colors palette, 8 colors scale from background to foreground
+typedef struct {
+  uint16_t m_bgcolor;                     // background color
+  uint16_t m_fgcolor;                     // foreground color
+  uint16_t m_colors[8];                   // byte swapped colors to display
+} display_palette_s;
+
+
+#define DISPLAY_PALETTE_CACHE_SIZE 4
+
+// recently used palettes
+typedef struct {
+  display_palette_s m_palettes[DISPLAY_PALETTE_CACHE_SIZE];
+  uint32_t m_stamps[DISPLAY_PALETTE_CACHE_SIZE]; // last use time of each palette
+  uint32_t m_clock;                       // use time counter
+  int m_count;                            // palettes in cache
+} display_palette_cache_s;
+
+
+// utf8_decode errors
+#define UTF8_OK         0                 // no errors
+#define UTF8_INVALID    1                 // bad lead or continuation byte, overlong form, surrogate, code above 0x10FFFF
+#define UTF8_TRUNCATED  2                 // sequence is cut by end of text
+
+// codes decoded at once
+#define UTF8_DECODE_BATCH 32
+
+
+// codes of one text line (up to LF) for placing its symbols, utf-8 is decoded by batches, CR is skipped
+typedef struct {
+  const char * m_str;                     // next byte to decode
+  const char * m_end;                     // end of line (LF or end of string)
+  const char * m_next;                    // next text line (after LF), or 0 at end of string
+  uint32_t m_codes[UTF8_DECODE_BATCH];    // decoded codes
+  int m_count;                            // decoded codes count
+  int m_pos;                              // next code within m_codes
+  int m_error;                            // UTF8_OK, or error of last decoded batch
+} line_codes_s;
+
+
+// output rotation, clockwise
+#define DISPLAY_ROTATE_0    0
+#define DISPLAY_ROTATE_90   1             // top row of text becomes right column
+#define DISPLAY_ROTATE_180  2
+#define DISPLAY_ROTATE_270  3             // top row of text becomes left column
+
+
+// display char structure, for fonts with compact symbols table m_symbol points to m_symbol_buf
+// (re-init after copy of structure)
 typedef struct {
   const packed_font_desc_s * m_font;      // font desc ptr
   const packed_symbol_desc_s * m_symbol;  // symbol desc ptr
@@ -45,29 +156,118 @@ typedef struct {
   int m_row;                              // current row to display
   uint16_t * m_pixbuf;                    // dst pixels row
   int m_cols_count;                       // width of pixels for symbol place
-  uint16_t * m_colors;                    // ptr to 8 colors, scale from background to foreground
+  const uint16_t * m_colors;              // ptr to 8 colors, scale from background to foreground
   int m_counter;                          // repeated colors
   int m_curr_color;                       // current color
   int m_last_row;                         // last symbol row within it place
   int m_last_col;                         // last symbol col within it place
   uint8_t m_curr_byte;                    // current packed byte
   bool m_curr_nibble;                     // current nibble
+  uint32_t m_bit_pos;                     // position in bits of huffman coded data
+  int m_symbol_idx;                       // symbol index within font
+  packed_symbol_desc_s m_symbol_buf;      // symbol desc unpacked from compact symbols table
 } display_char_s;
 
 
+// display text line structure
+typedef struct {
+  const packed_font_desc_s * m_font;      // font desc ptr
+  display_char_s * m_chars;               // symbols within line, one decoder per symbol
+  int m_chars_count;                      // used decoders
+  uint16_t * m_pixbuf;                    // dst pixels row
+  int m_width;                            // dst row width in pixels
+  int m_text_width;                       // width in pixels of placed symbols
+  int m_row;                              // current row to display
+  uint16_t m_bgcolor;                     // packed background color for tail
+  const char * m_next;                    // next text line (after LF), or 0 at end of string
+} display_line_s;
+
+
+// clipped text line, text is scrolled by pixels offset, only visible pixels of symbols are written,
+// m_line.m_chars - visible symbols, m_line.m_text_width - end of visible text within row
+typedef struct {
+  display_line_s m_line;                  // visible symbols of line
+  int m_lead;                             // background pixels before text (negative offset)
+  int m_first_skip;                       // hidden left columns of first visible symbol
+  int m_last_count;                       // visible columns of last visible symbol
+} display_line_clip_s;
+
+
+// build palette for background and foreground colors
+void display_palette_init( display_palette_s * a_palette, uint16_t a_bgcolor, uint16_t a_fgcolor );
+// init empty palettes cache
+void display_palette_cache_init( display_palette_cache_s * a_cache );
+// get palette from cache, build it if absent in place of least recently used one,
+// pointer is valid while palette stays in cache
+const display_palette_s * display_palette_get( display_palette_cache_s * a_cache, uint16_t a_bgcolor, uint16_t a_fgcolor );
+
 // prepare to display symbol, init a_data structure
 void display_char_init( display_char_s * a_data, uint32_t a_code, const packed_font_desc_s * a_font, uint16_t * a_dst_row, uint16_t a_bgcolor, uint16_t a_fgcolor, uint16_t * a_colors_tbl );
+// prepare to display symbol, init a_data structure using prepared palette
+void display_char_init_pal( display_char_s * a_data, uint32_t a_code, const packed_font_desc_s * a_font, uint16_t * a_dst_row, const display_palette_s * a_palette );
 // prepare to display symbol, init a_data structure using existing font, colors and buffer
 void display_char_init2( display_char_s * a_data, uint32_t a_code );
+// prepare to display symbol found before (a_symbol of a_data->m_font with index a_symbol_idx), no search,
+// init a_data structure using existing font, colors and buffer; a_symbol must stay valid while symbol is displayed
+void display_char_init_symbol( display_char_s * a_data, const packed_symbol_desc_s * a_symbol, int a_symbol_idx );
 // prepare to display symbol, init a_data structure using font and colors from other
 void display_char_init3( display_char_s * a_data, uint32_t a_code, uint16_t * a_dst_row, display_char_s * a_from );
 
 // prepare one row pixels buffer, returns true, if it was last row
 bool display_char_row( display_char_s * a_data );
+// prepare one row of a_count pixels of symbol place from column a_first (within x_advance), hidden
+// pixels are decoded without writing, returns true, if it was last row
+bool display_char_row_clip( display_char_s * a_data, int a_first, int a_count );
+// prepare one row of shades, from 0 (background) to 7 (foreground), returns true, if it was last row
+bool display_char_row_shades( display_char_s * a_data, uint8_t * a_dst );
+// get next run of current color (m_curr_color, 0..7) within symbol bitmap row, up to a_max pixels, returns
+// run length; for renderers into other outputs, which walk bitmap rows and count m_row themselves
+int display_char_next_run( display_char_s * a_data, int a_max );
+// set row to display next, fast if font has rows index
+void display_char_seek_row( display_char_s * a_data, int a_row );
+// prepare to display one text line (up to LF), symbols not fitting into a_width are dropped
+// a_chars - storage for a_chars_max symbol decoders
+void display_line_init( display_line_s * a_data, const char * a_str, const packed_font_desc_s * a_font, uint16_t * a_dst_row, int a_width, display_char_s * a_chars, int a_chars_max, uint16_t a_bgcolor, uint16_t a_fgcolor, uint16_t * a_colors_tbl );
+// prepare to display one text line using prepared palette
+void display_line_init_pal( display_line_s * a_data, const char * a_str, const packed_font_desc_s * a_font, uint16_t * a_dst_row, int a_width, display_char_s * a_chars, int a_chars_max, const display_palette_s * a_palette );
+// prepare one full-width row pixels buffer for all symbols of line, returns true, if it was last row
+bool display_line_row( display_line_s * a_data );
+// set row to display next for all symbols of line
+void display_line_seek_row( display_line_s * a_data, int a_row );
+// prepare to display one text line (up to LF) scrolled by a_offset pixels (pixel a_offset of text is
+// at row pixel 0, negative - text starts at pixel -a_offset), symbols out of a_width row are skipped by
+// their x_advance without decoders; a_chars - storage for a_chars_max visible symbol decoders
+void display_line_init_clip( display_line_clip_s * a_data, const char * a_str, const packed_font_desc_s * a_font, uint16_t * a_dst_row, int a_width, int a_offset, display_char_s * a_chars, int a_chars_max, const display_palette_s * a_palette );
+// prepare one full-width row pixels buffer of clipped line, returns true, if it was last row,
+// display_line_seek_row( &(a_data->m_line), row ) sets row to display next
+bool display_line_row_clip( display_line_clip_s * a_data );
+// display rest rows of symbol (from current row) rotated by a_rotation (DISPLAY_ROTATE_*) directly into tile,
+// a_dst - top left pixel of tile: x_advance x row_height pixels (0, 180) or row_height x x_advance pixels (90, 270),
+// a_stride - pixels between tile rows; a_data->m_pixbuf isn't used, pixels after x_advance aren't written
+void display_char_rotated( display_char_s * a_data, int a_rotation, uint16_t * a_dst, int a_stride );
+// display rest rows of all symbols of line and background tail rotated by a_rotation directly into tile,
+// a_dst - top left pixel of tile: a_data->m_width x row_height pixels (0, 180) or row_height x a_data->m_width
+// pixels (90, 270), a_stride - pixels between tile rows; a_data->m_pixbuf isn't used
+void display_line_rotated( display_line_s * a_data, int a_rotation, uint16_t * a_dst, int a_stride );
+// get symbol desc by code, default symbol desc if code not found,
+// for fonts with compact symbols table desc is unpacked into a_buf
+const packed_symbol_desc_s * get_symbol_desc_buf( const packed_font_desc_s * a_font, uint32_t a_code, packed_symbol_desc_s * a_buf );
+// get symbol desc by code, default symbol desc if code not found, fonts with m_symbols only
+const packed_symbol_desc_s * get_symbol_desc( const packed_font_desc_s * a_font, uint32_t a_code );
 // get rectangle size for text
 void get_text_extent( const packed_font_desc_s * a_font, const char * a_str, int * a_width, int * a_height );
-// get next symbol (uni)code
+// get next symbol (uni)code, 0 at end of string or invalid sequence
 uint32_t get_next_utf8_code( const char ** a_ptr );
+// decode utf-8 text from *a_ptr up to a_end into a_codes, a_codes_max codes at most, returns codes count,
+// *a_ptr is moved after decoded codes, decoding stops at bad sequence (*a_ptr points to it) with *a_error set
+int utf8_decode( const char ** a_ptr, const char * a_end, uint32_t * a_codes, int a_codes_max, int * a_error );
+// start walking codes of text line a_str (up to LF)
+void line_codes_init( line_codes_s * a_codes, const char * a_str );
+// get next code of line, returns false at end of line or at invalid sequence
+bool line_codes_next( line_codes_s * a_codes, uint32_t * a_code );
+// next text line (after LF) for line walked up to any code, 0 at end of string or if invalid sequence
+// was met (invalid sequence ends text)
+const char * line_codes_rest( const line_codes_s * a_codes );
 
 
 #ifdef __cplusplus
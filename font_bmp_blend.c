@@ -0,0 +1,158 @@
+#include "font_bmp_blend.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BLEND_X86
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// symbol row of shades, x_offset + width may exceed x_advance up to 255 pixels
+#define BLEND_ROW_BUFFER_SIZE 512
+
+// weight of shade in 1/256 units, (a_shade * 256) / 7 without division
+#define SHADE_WEIGHT(a_shade) (((a_shade) * 2341) >> 6)
+
+// byte swapped R5G6B5 blending function
+typedef void (*blend_kernel_t)( uint16_t * a_dst, const uint8_t * a_shades, int a_count, uint16_t a_fgcolor );
+
+
+// blend one pixel, a_dst byte swapped, a_fgcolor not
+static uint16_t blend_pixel( uint16_t a_dst, uint8_t a_shade, uint16_t a_fgcolor ) {
+  int v_w = SHADE_WEIGHT(a_shade);
+  int v_d = (uint16_t)((a_dst >> 8) | (a_dst << 8));
+  int r = (((v_d >> 11) * (256 - v_w)) + ((a_fgcolor >> 11) * v_w)) >> 8;
+  int g = ((((v_d >> 5) & 0x3F) * (256 - v_w)) + (((a_fgcolor >> 5) & 0x3F) * v_w)) >> 8;
+  int b = (((v_d & 0x1F) * (256 - v_w)) + ((a_fgcolor & 0x1F) * v_w)) >> 8;
+  uint16_t v_c = (uint16_t)((r << 11) | (g << 5) | b);
+  return (v_c >> 8) | (v_c << 8);
+}
+
+
+static void blend_kernel_scalar( uint16_t * a_dst, const uint8_t * a_shades, int a_count, uint16_t a_fgcolor ) {
+  for ( int i = 0; i < a_count; ++i ) {
+    if ( 0 != a_shades[i] ) {
+      a_dst[i] = blend_pixel( a_dst[i], a_shades[i], a_fgcolor );
+    }
+  }
+}
+
+
+#ifdef BLEND_X86
+
+// 8 pixels per step, blocks of transparent pixels are skipped
+__attribute__((target("sse2")))
+static void blend_kernel_sse2( uint16_t * a_dst, const uint8_t * a_shades, int a_count, uint16_t a_fgcolor ) {
+  const __m128i v_zero = _mm_setzero_si128();
+  const __m128i v_256 = _mm_set1_epi16( 256 );
+  const __m128i v_mask_6 = _mm_set1_epi16( 0x3F );
+  const __m128i v_mask_5 = _mm_set1_epi16( 0x1F );
+  const __m128i v_fr = _mm_set1_epi16( a_fgcolor >> 11 );
+  const __m128i v_fg = _mm_set1_epi16( (a_fgcolor >> 5) & 0x3F );
+  const __m128i v_fb = _mm_set1_epi16( a_fgcolor & 0x1F );
+  int i = 0;
+  for ( ; i + 8 <= a_count; i += 8 ) {
+    __m128i v_s = _mm_loadl_epi64( (const __m128i *)(a_shades + i) );
+    if ( 0xFFFF == _mm_movemask_epi8( _mm_cmpeq_epi8( v_s, v_zero ) ) ) {
+      continue;
+    }
+    __m128i v_w = _mm_srli_epi16( _mm_mullo_epi16( _mm_unpacklo_epi8( v_s, v_zero ), _mm_set1_epi16( 2341 ) ), 6 );
+    __m128i v_iw = _mm_sub_epi16( v_256, v_w );
+    __m128i v_d = _mm_loadu_si128( (const __m128i *)(a_dst + i) );
+    v_d = _mm_or_si128( _mm_slli_epi16( v_d, 8 ), _mm_srli_epi16( v_d, 8 ) );
+    __m128i r = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( _mm_srli_epi16( v_d, 11 ), v_iw ), _mm_mullo_epi16( v_fr, v_w ) ), 8 );
+    __m128i g = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( _mm_and_si128( _mm_srli_epi16( v_d, 5 ), v_mask_6 ), v_iw ), _mm_mullo_epi16( v_fg, v_w ) ), 8 );
+    __m128i b = _mm_srli_epi16( _mm_add_epi16( _mm_mullo_epi16( _mm_and_si128( v_d, v_mask_5 ), v_iw ), _mm_mullo_epi16( v_fb, v_w ) ), 8 );
+    __m128i v_c = _mm_or_si128( _mm_or_si128( _mm_slli_epi16( r, 11 ), _mm_slli_epi16( g, 5 ) ), b );
+    v_c = _mm_or_si128( _mm_slli_epi16( v_c, 8 ), _mm_srli_epi16( v_c, 8 ) );
+    _mm_storeu_si128( (__m128i *)(a_dst + i), v_c );
+  }
+  blend_kernel_scalar( a_dst + i, a_shades + i, a_count - i, a_fgcolor );
+}
+
+
+// 16 pixels per step, blocks of transparent pixels are skipped
+__attribute__((target("avx2")))
+static void blend_kernel_avx2( uint16_t * a_dst, const uint8_t * a_shades, int a_count, uint16_t a_fgcolor ) {
+  const __m128i v_zero8 = _mm_setzero_si128();
+  const __m256i v_256 = _mm256_set1_epi16( 256 );
+  const __m256i v_mask_6 = _mm256_set1_epi16( 0x3F );
+  const __m256i v_mask_5 = _mm256_set1_epi16( 0x1F );
+  const __m256i v_fr = _mm256_set1_epi16( a_fgcolor >> 11 );
+  const __m256i v_fg = _mm256_set1_epi16( (a_fgcolor >> 5) & 0x3F );
+  const __m256i v_fb = _mm256_set1_epi16( a_fgcolor & 0x1F );
+  int i = 0;
+  for ( ; i + 16 <= a_count; i += 16 ) {
+    __m128i v_s = _mm_loadu_si128( (const __m128i *)(a_shades + i) );
+    if ( 0xFFFF == _mm_movemask_epi8( _mm_cmpeq_epi8( v_s, v_zero8 ) ) ) {
+      continue;
+    }
+    __m256i v_w = _mm256_srli_epi16( _mm256_mullo_epi16( _mm256_cvtepu8_epi16( v_s ), _mm256_set1_epi16( 2341 ) ), 6 );
+    __m256i v_iw = _mm256_sub_epi16( v_256, v_w );
+    __m256i v_d = _mm256_loadu_si256( (const __m256i *)(a_dst + i) );
+    v_d = _mm256_or_si256( _mm256_slli_epi16( v_d, 8 ), _mm256_srli_epi16( v_d, 8 ) );
+    __m256i r = _mm256_srli_epi16( _mm256_add_epi16( _mm256_mullo_epi16( _mm256_srli_epi16( v_d, 11 ), v_iw ), _mm256_mullo_epi16( v_fr, v_w ) ), 8 );
+    __m256i g = _mm256_srli_epi16( _mm256_add_epi16( _mm256_mullo_epi16( _mm256_and_si256( _mm256_srli_epi16( v_d, 5 ), v_mask_6 ), v_iw ), _mm256_mullo_epi16( v_fg, v_w ) ), 8 );
+    __m256i b = _mm256_srli_epi16( _mm256_add_epi16( _mm256_mullo_epi16( _mm256_and_si256( v_d, v_mask_5 ), v_iw ), _mm256_mullo_epi16( v_fb, v_w ) ), 8 );
+    __m256i v_c = _mm256_or_si256( _mm256_or_si256( _mm256_slli_epi16( r, 11 ), _mm256_slli_epi16( g, 5 ) ), b );
+    v_c = _mm256_or_si256( _mm256_slli_epi16( v_c, 8 ), _mm256_srli_epi16( v_c, 8 ) );
+    _mm256_storeu_si256( (__m256i *)(a_dst + i), v_c );
+  }
+  blend_kernel_sse2( a_dst + i, a_shades + i, a_count - i, a_fgcolor );
+}
+
+#endif // BLEND_X86
+
+
+// blending kernel, scalar until selected
+static blend_kernel_t g_blend_kernel = blend_kernel_scalar;
+
+
+#ifdef BLEND_X86
+// best kernel is selected once at program start, before any rendering threads
+__attribute__((constructor))
+static void blend_kernel_select( void ) {
+  __builtin_cpu_init();
+  if ( __builtin_cpu_supports( "avx2" ) ) {
+    g_blend_kernel = blend_kernel_avx2;
+  } else if ( __builtin_cpu_supports( "sse2" ) ) {
+    g_blend_kernel = blend_kernel_sse2;
+  }
+}
+#endif
+
+
+void blend_shades_row( uint16_t * a_dst, const uint8_t * a_shades, int a_count, uint16_t a_fgcolor ) {
+  g_blend_kernel( a_dst, a_shades, a_count, a_fgcolor );
+}
+
+
+void display_char_init_blend( display_char_s * a_data, uint32_t a_code, const packed_font_desc_s * a_font, uint16_t * a_dst_row ) {
+  a_data->m_font = a_font;
+  a_data->m_pixbuf = a_dst_row;
+  a_data->m_colors = 0;
+  display_char_init2( a_data, a_code );
+}
+
+
+bool display_char_blend_row( display_char_s * a_data, uint16_t a_fgcolor ) {
+  uint8_t v_shades[BLEND_ROW_BUFFER_SIZE];
+  bool v_result = display_char_row_shades( a_data, v_shades );
+  blend_shades_row( a_data->m_pixbuf, v_shades, a_data->m_cols_count, a_fgcolor );
+  return v_result;
+}
+
+
+bool display_line_blend_row( display_line_s * a_data, uint16_t a_fgcolor ) {
+  for ( int i = 0; i < a_data->m_chars_count; ++i ) {
+    display_char_blend_row( &(a_data->m_chars[i]), a_fgcolor );
+  }
+  return ++a_data->m_row >= a_data->m_font->m_row_height;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,27 @@
+#ifndef __FONT_BMP_BLEND_H__
+#define __FONT_BMP_BLEND_H__
+
+#include "font_bmp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// transparent text output: symbol shades are coverage of foreground color,
+// blended in place with existing byte swapped R5G6B5 pixels, background is not drawn
+
+// prepare to blend symbol, init a_data structure, colors table isn't used
+void display_char_init_blend( display_char_s * a_data, uint32_t a_code, const packed_font_desc_s * a_font, uint16_t * a_dst_row );
+// blend one row of symbol onto pixels at a_data->m_pixbuf, returns true, if it was last row
+bool display_char_blend_row( display_char_s * a_data, uint16_t a_fgcolor );
+// blend one row of all symbols of line onto pixels at a_data->m_pixbuf, returns true, if it was last row
+bool display_line_blend_row( display_line_s * a_data, uint16_t a_fgcolor );
+// blend a_count pixels with a_fgcolor using shades 0..7 as coverage, pixels with shade 0 aren't touched
+void blend_shades_row( uint16_t * a_dst, const uint8_t * a_shades, int a_count, uint16_t a_fgcolor );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FONT_BMP_BLEND_H__
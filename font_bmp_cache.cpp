@@ -0,0 +1,187 @@
+//
+#include <memory>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+
+#include <string.h>
+
+#include "font_bmp_cache.h"
+
+
+#define GLYPH_CACHE_DEFAULT_SHARDS  16
+
+
+// cache key, symbol of font with colors
+struct glyph_key_s {
+  const packed_font_desc_s * m_font;
+  uint32_t m_code;                  // code of found symbol, default symbol code for absent codes
+  uint16_t m_bgcolor;
+  uint16_t m_fgcolor;
+  bool operator == ( const glyph_key_s & a_other ) const {
+    return m_font == a_other.m_font
+        && m_code == a_other.m_code
+        && m_bgcolor == a_other.m_bgcolor
+        && m_fgcolor == a_other.m_fgcolor;
+  }
+};
+
+
+struct glyph_key_hash_s {
+  size_t operator () ( const glyph_key_s & a_key ) const {
+    uint64_t v_hash = (uint64_t)(uintptr_t)a_key.m_font;
+    v_hash = (v_hash ^ (uint64_t)a_key.m_code) * 0x9E3779B97F4A7C15ULL;
+    v_hash = (v_hash ^ (((uint64_t)a_key.m_bgcolor << 16) | a_key.m_fgcolor)) * 0x9E3779B97F4A7C15ULL;
+    return (size_t)(v_hash ^ (v_hash >> 32));
+  }
+};
+
+
+// decoded symbol, x_advance * row_height pixels
+struct glyph_bitmap_s {
+  int m_width;
+  int m_height;
+  std::vector<uint16_t> m_pixels;
+};
+
+
+// cache part with own lock, most recently used symbols at front of list
+struct glyph_cache_shard_s {
+  typedef std::list<std::pair<glyph_key_s, std::shared_ptr<const glyph_bitmap_s> > > lru_list_t;
+  std::mutex m_lock;
+  lru_list_t m_lru;
+  std::unordered_map<glyph_key_s, lru_list_t::iterator, glyph_key_hash_s> m_map;
+  size_t m_bytes;
+  size_t m_budget;
+  glyph_cache_shard_s() : m_bytes(0), m_budget(0) {}
+};
+
+
+struct glyph_cache_s {
+  std::vector<glyph_cache_shard_s> m_shards;
+  std::atomic<uint64_t> m_hits;
+  std::atomic<uint64_t> m_misses;
+  std::atomic<uint64_t> m_evictions;
+  glyph_cache_s( int a_shards ) : m_shards(a_shards), m_hits(0), m_misses(0), m_evictions(0) {}
+};
+
+
+static size_t get_bitmap_bytes( const glyph_bitmap_s & a_bmp ) {
+  return a_bmp.m_pixels.size() * sizeof(uint16_t);
+}
+
+
+// decode whole symbol bitmap
+static std::shared_ptr<const glyph_bitmap_s> decode_glyph( const glyph_key_s & a_key ) {
+  std::shared_ptr<glyph_bitmap_s> v_result = std::make_shared<glyph_bitmap_s>();
+  packed_symbol_desc_s v_buf;
+  v_result->m_width = get_symbol_desc_buf( a_key.m_font, a_key.m_code, &v_buf )->m_x_advance;
+  v_result->m_height = a_key.m_font->m_row_height;
+  v_result->m_pixels.resize( (size_t)v_result->m_width * v_result->m_height );
+  display_char_s v_char;
+  uint16_t v_colors[8];
+  display_char_init( &v_char, a_key.m_code, a_key.m_font, v_result->m_pixels.data(), a_key.m_bgcolor, a_key.m_fgcolor, v_colors );
+  // symbol pixels beyond x_advance (x_offset + width) are decoded without writing
+  for ( int y = 0; y < v_result->m_height; ++y ) {
+    v_char.m_pixbuf = v_result->m_pixels.data() + (size_t)y * v_result->m_width;
+    display_char_row_clip( &v_char, 0, v_result->m_width );
+  }
+  return v_result;
+}
+
+
+glyph_cache_s * glyph_cache_create( size_t a_budget_bytes, int a_shards ) {
+  if ( a_shards <= 0 ) {
+    a_shards = GLYPH_CACHE_DEFAULT_SHARDS;
+  }
+  glyph_cache_s * v_result = new glyph_cache_s( a_shards );
+  for ( glyph_cache_shard_s & v_shard: v_result->m_shards ) {
+    v_shard.m_budget = a_budget_bytes / a_shards;
+  }
+  return v_result;
+}
+
+
+void glyph_cache_destroy( glyph_cache_s * a_cache ) {
+  delete a_cache;
+}
+
+
+int glyph_cache_draw( glyph_cache_s * a_cache, const packed_font_desc_s * a_font, uint32_t a_code, uint16_t a_bgcolor, uint16_t a_fgcolor, uint16_t * a_dst, int a_dst_stride ) {
+  glyph_key_s v_key;
+  v_key.m_font = a_font;
+  packed_symbol_desc_s v_buf;
+  v_key.m_code = get_symbol_desc_buf( a_font, a_code, &v_buf )->m_code;
+  v_key.m_bgcolor = a_bgcolor;
+  v_key.m_fgcolor = a_fgcolor;
+  size_t v_hash = glyph_key_hash_s()( v_key );
+  glyph_cache_shard_s & v_shard = a_cache->m_shards[(v_hash >> 8) % a_cache->m_shards.size()];
+  std::shared_ptr<const glyph_bitmap_s> v_bmp;
+  {
+    std::lock_guard<std::mutex> v_guard( v_shard.m_lock );
+    auto v_it = v_shard.m_map.find( v_key );
+    if ( v_it != v_shard.m_map.end() ) {
+      // move to front
+      v_shard.m_lru.splice( v_shard.m_lru.begin(), v_shard.m_lru, v_it->second );
+      v_bmp = v_it->second->second;
+    }
+  }
+  if ( v_bmp ) {
+    ++a_cache->m_hits;
+  } else {
+    ++a_cache->m_misses;
+    // decode without lock, other threads can use shard meanwhile
+    v_bmp = decode_glyph( v_key );
+    size_t v_bytes = get_bitmap_bytes( *v_bmp );
+    if ( v_bytes <= v_shard.m_budget ) {
+      std::lock_guard<std::mutex> v_guard( v_shard.m_lock );
+      auto v_it = v_shard.m_map.find( v_key );
+      if ( v_it == v_shard.m_map.end() ) {
+        // free space for new symbol, least recently used first
+        while ( v_shard.m_bytes + v_bytes > v_shard.m_budget ) {
+          v_shard.m_bytes -= get_bitmap_bytes( *v_shard.m_lru.back().second );
+          v_shard.m_map.erase( v_shard.m_lru.back().first );
+          v_shard.m_lru.pop_back();
+          ++a_cache->m_evictions;
+        }
+        v_shard.m_lru.emplace_front( v_key, v_bmp );
+        v_shard.m_map.emplace( v_key, v_shard.m_lru.begin() );
+        v_shard.m_bytes += v_bytes;
+      }
+    }
+  }
+  // copy rows
+  const uint16_t * v_src = v_bmp->m_pixels.data();
+  for ( int y = 0; y < v_bmp->m_height; ++y ) {
+    ::memcpy( a_dst, v_src, v_bmp->m_width * sizeof(uint16_t) );
+    v_src += v_bmp->m_width;
+    a_dst += a_dst_stride;
+  }
+  return v_bmp->m_width;
+}
+
+
+void glyph_cache_clear( glyph_cache_s * a_cache ) {
+  for ( glyph_cache_shard_s & v_shard: a_cache->m_shards ) {
+    std::lock_guard<std::mutex> v_guard( v_shard.m_lock );
+    v_shard.m_map.clear();
+    v_shard.m_lru.clear();
+    v_shard.m_bytes = 0;
+  }
+}
+
+
+void glyph_cache_get_stats( glyph_cache_s * a_cache, glyph_cache_stats_s * a_stats ) {
+  a_stats->m_hits = a_cache->m_hits;
+  a_stats->m_misses = a_cache->m_misses;
+  a_stats->m_evictions = a_cache->m_evictions;
+  a_stats->m_bytes = 0;
+  a_stats->m_entries = 0;
+  for ( glyph_cache_shard_s & v_shard: a_cache->m_shards ) {
+    std::lock_guard<std::mutex> v_guard( v_shard.m_lock );
+    a_stats->m_bytes += v_shard.m_bytes;
+    a_stats->m_entries += v_shard.m_map.size();
+  }
+}
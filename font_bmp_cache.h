@@ -0,0 +1,43 @@
+#ifndef __FONT_BMP_CACHE_H__
+#define __FONT_BMP_CACHE_H__
+
+#include <stddef.h>
+
+#include "font_bmp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// cache of decoded symbols bitmaps, for host side renderers,
+// thread-safe, split into shards with own lock and LRU list each
+typedef struct glyph_cache_s glyph_cache_s;
+
+// cache statistics
+typedef struct {
+  uint64_t m_hits;          // symbols found in cache
+  uint64_t m_misses;        // symbols decoded
+  uint64_t m_evictions;     // symbols removed to fit into memory budget
+  size_t m_bytes;           // memory used by cached bitmaps
+  size_t m_entries;         // cached symbols count
+} glyph_cache_stats_s;
+
+
+// create cache, a_budget_bytes - memory for bitmaps, a_shards - count of independent parts (0 - default)
+glyph_cache_s * glyph_cache_create( size_t a_budget_bytes, int a_shards );
+// destroy cache and free all bitmaps
+void glyph_cache_destroy( glyph_cache_s * a_cache );
+// draw symbol x_advance * row_height pixels into a_dst with a_dst_stride pixels per row,
+// decodes symbol on cache miss, returns x_advance of symbol
+int glyph_cache_draw( glyph_cache_s * a_cache, const packed_font_desc_s * a_font, uint32_t a_code, uint16_t a_bgcolor, uint16_t a_fgcolor, uint16_t * a_dst, int a_dst_stride );
+// remove all symbols from cache
+void glyph_cache_clear( glyph_cache_s * a_cache );
+// get cache statistics
+void glyph_cache_get_stats( glyph_cache_s * a_cache, glyph_cache_stats_s * a_stats );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FONT_BMP_CACHE_H__
@@ -0,0 +1,144 @@
+#ifndef __FONT_BMP_CONSTEXPR_H__
+#define __FONT_BMP_CONSTEXPR_H__
+
+// compile time text measurement, C++17, header only:
+// font metrics header is written by font_2_src -x, functions give the same results as
+// get_text_extent() for the same font, e.g.
+//   constexpr constexpr_extent_s v_size = constexpr_text_extent( test32_metrics, "Settings" );
+//   constexpr int v_x = (320 - v_size.m_width) / 2;
+
+#include <cstddef>
+#include <cstdint>
+
+
+// symbol metrics, sorted by code
+struct constexpr_symbol_s {
+  uint32_t m_code;                        // code
+  uint8_t m_x_advance;                    // displayed width of symbol
+};
+
+
+// font metrics
+struct constexpr_font_s {
+  const constexpr_symbol_s * m_symbols;   // symbols sorted by code
+  int m_symbols_count;                    // total symbols
+  int m_row_height;                       // text row height
+  int m_def_code_idx;                     // default symbol index, if symbol code not found
+};
+
+
+// text rectangle size
+struct constexpr_extent_s {
+  int m_width;
+  int m_height;
+};
+
+
+// symbol index by code, binary search, default symbol index if code not found
+constexpr int constexpr_find_symbol_index( const constexpr_font_s & a_font, uint32_t a_code ) {
+  int l = 0;
+  int u = a_font.m_symbols_count - 1;
+  while ( l <= u ) {
+    int v_mid = (l + u) / 2;
+    uint32_t v_code = a_font.m_symbols[v_mid].m_code;
+    if ( v_code == a_code ) {
+      return v_mid;
+    }
+    if ( v_code < a_code ) {
+      l = v_mid + 1;
+    } else {
+      u = v_mid - 1;
+    }
+  }
+  return a_font.m_def_code_idx;
+}
+
+
+// decode one utf-8 sequence of a_avail bytes at most, same checks as utf8_decode():
+// returns sequence length, 0 for invalid sequence, -1 for sequence cut by a_avail
+constexpr int constexpr_utf8_sequence( const char * a_src, size_t a_avail, uint32_t & a_code ) {
+  uint32_t v_lead = (uint8_t)a_src[0];
+  if ( v_lead < 0x80 ) {
+    a_code = v_lead;
+    return 1;
+  }
+  int v_len = 0;
+  uint32_t v_min = 0x80;
+  uint32_t v_max = 0xBF;
+  if ( v_lead >= 0xC2 && v_lead <= 0xDF ) {
+    v_len = 2;
+    a_code = v_lead & 0x1F;
+  } else if ( v_lead >= 0xE0 && v_lead <= 0xEF ) {
+    v_len = 3;
+    a_code = v_lead & 0x0F;
+    // no overlong forms and surrogates
+    v_min = 0xE0 == v_lead ? 0xA0 : 0x80;
+    v_max = 0xED == v_lead ? 0x9F : 0xBF;
+  } else if ( v_lead >= 0xF0 && v_lead <= 0xF4 ) {
+    v_len = 4;
+    a_code = v_lead & 0x07;
+    // no overlong forms and codes above 0x10FFFF
+    v_min = 0xF0 == v_lead ? 0x90 : 0x80;
+    v_max = 0xF4 == v_lead ? 0x8F : 0xBF;
+  } else {
+    return 0;
+  }
+  for ( int i = 1; i < v_len; ++i ) {
+    if ( (size_t)i >= a_avail ) {
+      return -1;
+    }
+    uint32_t v_byte = (uint8_t)a_src[i];
+    if ( v_byte < v_min || v_byte > v_max ) {
+      return 0;
+    }
+    a_code = (a_code << 6) | (v_byte & 0x3F);
+    v_min = 0x80;
+    v_max = 0xBF;
+  }
+  return v_len;
+}
+
+
+// get rectangle size for text, same as get_text_extent(): CR starts line again, LF starts next line,
+// text ends at NUL or invalid sequence
+constexpr constexpr_extent_s constexpr_text_extent( const constexpr_font_s & a_font, const char * a_str ) {
+  size_t v_avail = 0;
+  while ( a_str[v_avail] ) {
+    ++v_avail;
+  }
+  int v_width = 0;
+  int v_height = 0;
+  int v_max_width = 0;
+  int v_height_add = a_font.m_row_height;
+  while ( v_avail > 0 ) {
+    uint32_t v_code = 0;
+    int v_len = constexpr_utf8_sequence( a_str, v_avail, v_code );
+    if ( v_len <= 0 ) {
+      break;
+    }
+    a_str += v_len;
+    v_avail -= v_len;
+    if ( '\r' == v_code ) {
+      v_width = 0;
+      continue;
+    }
+    if ( '\n' == v_code ) {
+      v_height_add += a_font.m_row_height;
+      v_width = 0;
+      continue;
+    }
+    // increase height at first symbol
+    if ( 0 == v_width ) {
+      v_height += v_height_add;
+      v_height_add = 0;
+    }
+    v_width += a_font.m_symbols[constexpr_find_symbol_index( a_font, v_code )].m_x_advance;
+    if ( v_width > v_max_width ) {
+      v_max_width = v_width;
+    }
+  }
+  return constexpr_extent_s{ v_max_width, v_height };
+}
+
+
+#endif // __FONT_BMP_CONSTEXPR_H__
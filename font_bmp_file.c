@@ -0,0 +1,300 @@
+#include "font_bmp_file.h"
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// section ptr, 0 if section is absent
+static const void * get_section( const uint8_t * a_data, const font_file_header_s * a_header, int a_section ) {
+  const font_file_section_s * v_section = &(a_header->m_sections[a_section]);
+  return 0 != v_section->m_size ? a_data + v_section->m_offset : 0;
+}
+
+
+// check section bounds, alignment and size for a_count items of a_item_size bytes (0 - any)
+static bool check_section( const font_file_header_s * a_header, int a_section, uint32_t a_item_size, uint64_t a_count ) {
+  const font_file_section_s * v_section = &(a_header->m_sections[a_section]);
+  if ( 0 == v_section->m_size ) {
+    return true;
+  }
+  if ( 0 != (v_section->m_offset % FONT_FILE_ALIGN)
+    || v_section->m_offset < a_header->m_header_size
+    || (uint64_t)v_section->m_offset + v_section->m_size > a_header->m_file_size ) {
+    return false;
+  }
+  if ( 0 != a_item_size ) {
+    return (uint64_t)v_section->m_size == a_count * a_item_size;
+  }
+  return true;
+}
+
+
+// packed data position in nibbles (in bits for huffman coded data) within packed data
+static bool check_packed_pos( const packed_font_desc_s * a_font, uint64_t a_pos ) {
+  return a_pos <= ((uint64_t)a_font->m_bmp_size << (a_font->m_huffman ? 3 : 1));
+}
+
+
+// position of decoder in nibbles (in bits for huffman coded data), current byte is already read
+static uint64_t get_decoder_pos( const display_char_s * a_char ) {
+  if ( a_char->m_font->m_huffman ) {
+    return a_char->m_bit_pos;
+  }
+  return ((uint64_t)(a_char->m_bmp_ptr - 1 - a_char->m_font->m_bmp) << 1) | (a_char->m_curr_nibble ? 1 : 0);
+}
+
+
+// decode runs of symbol bitmap from a_pos, symbol data must end within packed data, decoding stops at first
+// run beyond it (one run reads at most 4 bytes ahead, within padding); rows index entries must be decoder
+// state at begin of their rows, so seeking restores the same state
+static bool check_symbol_data( const packed_font_desc_s * a_font, int a_idx, uint64_t a_pos, int a_width, int a_height ) {
+  packed_symbol_desc_s v_symbol;
+  memset( &v_symbol, 0, sizeof(v_symbol) );
+  v_symbol.m_offset = (uint32_t)(a_pos >> 1);
+  v_symbol.m_nibble = (uint32_t)(a_pos & 1);
+  v_symbol.m_width = (uint8_t)a_width;
+  v_symbol.m_height = (uint8_t)a_height;
+  display_char_s v_char;
+  v_char.m_font = a_font;
+  display_char_init_symbol( &v_char, &v_symbol, a_idx );
+  for ( int y = 0; y < a_height; ++y ) {
+    if ( a_font->m_rows && y > 0 ) {
+      uint32_t v_entry = a_font->m_rows[a_font->m_rows_first[a_idx] + y];
+      if ( ROWS_INDEX_POS(v_entry) != get_decoder_pos( &v_char )
+        || (int)ROWS_INDEX_COUNTER(v_entry) != v_char.m_counter
+        || (int)ROWS_INDEX_COLOR(v_entry) != v_char.m_curr_color ) {
+        return false;
+      }
+    }
+    for ( int x = 0; x < a_width; ) {
+      x += display_char_next_run( &v_char, a_width - x );
+      if ( !check_packed_pos( a_font, get_decoder_pos( &v_char ) ) ) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+
+// symbols packed data and their rows index entries, a_rows_count - entries in rows index,
+// packed data of all symbols is decoded once
+static bool check_symbols( const packed_font_desc_s * a_font, uint64_t a_rows_count ) {
+  const packed_compact_symbols_s * v_compact = a_font->m_compact;
+  for ( int i = 0; i < a_font->m_symbols_count; ++i ) {
+    uint64_t v_pos = 0;
+    int v_width;
+    int v_height;
+    if ( v_compact ) {
+      const uint8_t * v_rec = v_compact->m_metrics + (size_t)i * (COMPACT_METRICS_SIZE + v_compact->m_pos_bytes);
+      for ( int j = v_compact->m_pos_bytes - 1; j >= 0; --j ) {
+        v_pos = (v_pos << 8) | v_rec[COMPACT_METRICS_SIZE + j];
+      }
+      v_width = v_rec[0];
+      v_height = v_rec[1];
+    } else {
+      v_pos = ((uint64_t)a_font->m_symbols[i].m_offset << 1) | a_font->m_symbols[i].m_nibble;
+      v_width = a_font->m_symbols[i].m_width;
+      v_height = a_font->m_symbols[i].m_height;
+    }
+    if ( !check_packed_pos( a_font, v_pos ) ) {
+      return false;
+    }
+    // entry for each bitmap row, first one isn't used
+    if ( a_font->m_rows && (uint64_t)a_font->m_rows_first[i] + v_height > a_rows_count ) {
+      return false;
+    }
+    if ( !check_symbol_data( a_font, i, v_pos, v_width, v_height ) ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+// lookup tables give symbols indexes, ranges are sorted by codes
+static bool check_lookup( const packed_font_desc_s * a_font ) {
+  uint32_t v_count = (uint32_t)a_font->m_symbols_count;
+  if ( a_font->m_direct ) {
+    for ( int i = 0; i < DIRECT_CODES_COUNT; ++i ) {
+      if ( DIRECT_NO_SYMBOL != a_font->m_direct[i] && a_font->m_direct[i] >= v_count ) {
+        return false;
+      }
+    }
+  }
+  if ( a_font->m_ranges ) {
+    // last entry is end of last range
+    const packed_code_range_s * v_ranges = a_font->m_ranges;
+    for ( int i = 0; i < a_font->m_ranges_count; ++i ) {
+      if ( v_ranges[i].m_index > v_ranges[i + 1].m_index
+        || (i + 1 < a_font->m_ranges_count && v_ranges[i].m_code >= v_ranges[i + 1].m_code) ) {
+        return false;
+      }
+    }
+    if ( v_ranges[a_font->m_ranges_count].m_index > v_count ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+// huffman code gives known symbols, a_symbols_size - bytes of symbols table
+static bool check_huffman( const packed_huffman_s * a_huffman, uint64_t a_symbols_size ) {
+  for ( int i = 0; i < (1 << HUFFMAN_LOOKUP_BITS); ++i ) {
+    uint16_t v_entry = a_huffman->m_lookup[i];
+    if ( 0 != v_entry
+      && ((v_entry >> 8) > HUFFMAN_LOOKUP_BITS || 0 == (v_entry >> 8) || (v_entry & 0xFF) >= HUFFMAN_SYMBOLS) ) {
+      return false;
+    }
+  }
+  uint64_t v_codes = 0;
+  for ( int v_len = 1; v_len <= HUFFMAN_MAX_BITS; ++v_len ) {
+    v_codes += a_huffman->m_counts[v_len];
+  }
+  if ( v_codes > a_symbols_size ) {
+    return false;
+  }
+  for ( uint64_t i = 0; i < v_codes; ++i ) {
+    if ( a_huffman->m_symbols[i] >= HUFFMAN_SYMBOLS ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+// validate header, sections and tables contents, fill font desc
+bool font_file_load_mem( font_file_s * a_file, const void * a_data, size_t a_size ) {
+  const uint8_t * v_data = (const uint8_t *)a_data;
+  const font_file_header_s * v_header = (const font_file_header_s *)a_data;
+  a_file->m_map = 0;
+  a_file->m_map_size = 0;
+  if ( a_size < sizeof(font_file_header_s)
+    || 0 != ((uintptr_t)a_data % FONT_FILE_ALIGN)
+    || 0 != memcmp( v_header->m_magic, FONT_FILE_MAGIC, sizeof(v_header->m_magic) )
+    || FONT_FILE_VERSION != v_header->m_version
+    || FONT_FILE_BYTE_ORDER != v_header->m_byte_order
+    || sizeof(font_file_header_s) != v_header->m_header_size
+    || sizeof(packed_symbol_desc_s) != v_header->m_symbol_desc_size
+    || a_size < v_header->m_file_size
+    || v_header->m_symbols_count <= 0
+    || v_header->m_def_code_idx >= (uint32_t)v_header->m_symbols_count
+    || v_header->m_ranges_count < 0
+    || v_header->m_pos_bytes < 0 || v_header->m_pos_bytes > 4 ) {
+    return false;
+  }
+  uint64_t v_count = (uint64_t)v_header->m_symbols_count;
+  const font_file_section_s * v_sections = v_header->m_sections;
+  bool v_compact = 0 != v_sections[FONT_FILE_METRICS].m_size;
+  bool v_huffman = 0 != v_sections[FONT_FILE_HUFFMAN_LOOKUP].m_size;
+  // all sections within file, tables of expected size
+  if ( !check_section( v_header, FONT_FILE_BMP, 0, 0 )
+    || v_sections[FONT_FILE_BMP].m_size < (uint64_t)v_header->m_bmp_size + FONT_FILE_BMP_PADDING
+    || !check_section( v_header, FONT_FILE_SYMBOLS, sizeof(packed_symbol_desc_s), v_count )
+    || !check_section( v_header, FONT_FILE_ROWS_FIRST, sizeof(uint32_t), v_count )
+    || !check_section( v_header, FONT_FILE_ROWS, 0, 0 )
+    || 0 != (v_sections[FONT_FILE_ROWS].m_size % sizeof(uint32_t))
+    || !check_section( v_header, FONT_FILE_DIRECT, sizeof(uint16_t), DIRECT_CODES_COUNT )
+    || !check_section( v_header, FONT_FILE_RANGES, sizeof(packed_code_range_s), (uint64_t)v_header->m_ranges_count + 1 )
+    || !check_section( v_header, FONT_FILE_HUFFMAN_LOOKUP, sizeof(uint16_t), 1u << HUFFMAN_LOOKUP_BITS )
+    || !check_section( v_header, FONT_FILE_HUFFMAN_COUNTS, sizeof(uint16_t), HUFFMAN_MAX_BITS + 1 )
+    || !check_section( v_header, FONT_FILE_HUFFMAN_SYMBOLS, 0, 0 )
+    || !check_section( v_header, FONT_FILE_CODES16, sizeof(uint16_t), v_count )
+    || !check_section( v_header, FONT_FILE_CODES32, sizeof(uint32_t), v_count )
+    || !check_section( v_header, FONT_FILE_METRICS, COMPACT_METRICS_SIZE + v_header->m_pos_bytes, v_count ) ) {
+    return false;
+  }
+  // one symbols table, both parts of optional tables
+  if ( v_compact == (0 != v_sections[FONT_FILE_SYMBOLS].m_size)
+    || (v_compact && (0 == v_header->m_pos_bytes
+                   || (0 != v_sections[FONT_FILE_CODES16].m_size) == (0 != v_sections[FONT_FILE_CODES32].m_size)))
+    || (0 != v_sections[FONT_FILE_ROWS_FIRST].m_size) != (0 != v_sections[FONT_FILE_ROWS].m_size)
+    || (v_huffman && (0 == v_sections[FONT_FILE_HUFFMAN_COUNTS].m_size || 0 == v_sections[FONT_FILE_HUFFMAN_SYMBOLS].m_size))
+    || (0 != v_header->m_ranges_count) != (0 != v_sections[FONT_FILE_RANGES].m_size) ) {
+    return false;
+  }
+  packed_font_desc_s * v_font = &(a_file->m_font);
+  v_font->m_bmp = (const uint8_t *)get_section( v_data, v_header, FONT_FILE_BMP );
+  v_font->m_symbols_count = v_header->m_symbols_count;
+  v_font->m_row_height = v_header->m_row_height;
+  v_font->m_def_code_idx = v_header->m_def_code_idx;
+  v_font->m_symbols = (const packed_symbol_desc_s *)get_section( v_data, v_header, FONT_FILE_SYMBOLS );
+  v_font->m_rows_first = (const uint32_t *)get_section( v_data, v_header, FONT_FILE_ROWS_FIRST );
+  v_font->m_rows = (const uint32_t *)get_section( v_data, v_header, FONT_FILE_ROWS );
+  v_font->m_direct = (const uint16_t *)get_section( v_data, v_header, FONT_FILE_DIRECT );
+  v_font->m_ranges = (const packed_code_range_s *)get_section( v_data, v_header, FONT_FILE_RANGES );
+  v_font->m_ranges_count = v_header->m_ranges_count;
+  v_font->m_bmp_size = v_header->m_bmp_size;
+  v_font->m_huffman = 0;
+  v_font->m_compact = 0;
+  if ( v_huffman ) {
+    a_file->m_huffman.m_lookup = (const uint16_t *)get_section( v_data, v_header, FONT_FILE_HUFFMAN_LOOKUP );
+    a_file->m_huffman.m_counts = (const uint16_t *)get_section( v_data, v_header, FONT_FILE_HUFFMAN_COUNTS );
+    a_file->m_huffman.m_symbols = (const uint8_t *)get_section( v_data, v_header, FONT_FILE_HUFFMAN_SYMBOLS );
+    v_font->m_huffman = &(a_file->m_huffman);
+  }
+  if ( v_compact ) {
+    a_file->m_compact.m_codes16 = (const uint16_t *)get_section( v_data, v_header, FONT_FILE_CODES16 );
+    a_file->m_compact.m_codes32 = (const uint32_t *)get_section( v_data, v_header, FONT_FILE_CODES32 );
+    a_file->m_compact.m_metrics = (const uint8_t *)get_section( v_data, v_header, FONT_FILE_METRICS );
+    a_file->m_compact.m_pos_bytes = v_header->m_pos_bytes;
+    v_font->m_compact = &(a_file->m_compact);
+  }
+  a_file->m_max_symbol_width = v_header->m_max_symbol_width;
+  // tables contents used by decoder without checks, huffman code before symbols data decoding
+  return check_lookup( v_font )
+      && (!v_huffman || check_huffman( v_font->m_huffman, v_sections[FONT_FILE_HUFFMAN_SYMBOLS].m_size ))
+      && check_symbols( v_font, v_sections[FONT_FILE_ROWS].m_size / sizeof(uint32_t) );
+}
+
+
+// map font file read only
+bool font_file_open( font_file_s * a_file, const char * a_file_name ) {
+  a_file->m_map = 0;
+  a_file->m_map_size = 0;
+  int v_fd = open( a_file_name, O_RDONLY );
+  if ( v_fd < 0 ) {
+    return false;
+  }
+  struct stat v_stat;
+  if ( 0 != fstat( v_fd, &v_stat ) || v_stat.st_size < (off_t)sizeof(font_file_header_s) ) {
+    close( v_fd );
+    return false;
+  }
+  size_t v_size = (size_t)v_stat.st_size;
+  void * v_map = mmap( 0, v_size, PROT_READ, MAP_SHARED, v_fd, 0 );
+  // mapping keeps file
+  close( v_fd );
+  if ( MAP_FAILED == v_map ) {
+    return false;
+  }
+  if ( !font_file_load_mem( a_file, v_map, v_size ) ) {
+    munmap( v_map, v_size );
+    return false;
+  }
+  a_file->m_map = v_map;
+  a_file->m_map_size = v_size;
+  return true;
+}
+
+
+// unmap font file
+void font_file_close( font_file_s * a_file ) {
+  if ( a_file->m_map ) {
+    munmap( a_file->m_map, a_file->m_map_size );
+  }
+  a_file->m_map = 0;
+  a_file->m_map_size = 0;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,91 @@
+#ifndef __FONT_BMP_FILE_H__
+#define __FONT_BMP_FILE_H__
+
+#include <stddef.h>
+
+#include "font_bmp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// binary font file, written by font_2_src -b, for host side:
+// header, then sections with font tables as they are in memory, each aligned to FONT_FILE_ALIGN bytes,
+// native byte order and packed_symbol_desc_s layout of writer (checked by loader)
+#define FONT_FILE_MAGIC       "SBMPFONT"
+#define FONT_FILE_VERSION     1
+#define FONT_FILE_BYTE_ORDER  0x01020304u
+#define FONT_FILE_ALIGN       16
+// zero bytes after packed data, decoders read ahead
+#define FONT_FILE_BMP_PADDING 16
+
+// sections of font file
+enum {
+  FONT_FILE_BMP = 0,                      // packed data, m_bmp
+  FONT_FILE_SYMBOLS,                      // packed_symbol_desc_s array, m_symbols
+  FONT_FILE_ROWS_FIRST,                   // m_rows_first
+  FONT_FILE_ROWS,                         // m_rows
+  FONT_FILE_DIRECT,                       // m_direct
+  FONT_FILE_RANGES,                       // m_ranges
+  FONT_FILE_HUFFMAN_LOOKUP,               // m_huffman->m_lookup
+  FONT_FILE_HUFFMAN_COUNTS,               // m_huffman->m_counts
+  FONT_FILE_HUFFMAN_SYMBOLS,              // m_huffman->m_symbols
+  FONT_FILE_CODES16,                      // m_compact->m_codes16
+  FONT_FILE_CODES32,                      // m_compact->m_codes32
+  FONT_FILE_METRICS,                      // m_compact->m_metrics
+  FONT_FILE_SECTIONS
+};
+
+// section place within file, absent section has zero size
+typedef struct {
+  uint32_t m_offset;                      // from begin of file, multiple of FONT_FILE_ALIGN
+  uint32_t m_size;                        // bytes
+} font_file_section_s;
+
+// font file header
+typedef struct {
+  char m_magic[8];                        // FONT_FILE_MAGIC
+  uint32_t m_version;                     // FONT_FILE_VERSION
+  uint32_t m_byte_order;                  // FONT_FILE_BYTE_ORDER in writer byte order
+  uint32_t m_header_size;                 // sizeof(font_file_header_s)
+  uint32_t m_symbol_desc_size;            // sizeof(packed_symbol_desc_s)
+  uint32_t m_file_size;                   // whole file bytes
+  int32_t m_symbols_count;                // m_symbols_count of font
+  int32_t m_row_height;                   // m_row_height of font
+  uint32_t m_def_code_idx;                // m_def_code_idx of font
+  int32_t m_ranges_count;                 // m_ranges_count of font
+  uint32_t m_bmp_size;                    // m_bmp_size of font
+  int32_t m_pos_bytes;                    // m_pos_bytes of compact symbols table, 0 if absent
+  int32_t m_max_symbol_width;             // max x_advance of symbols
+  font_file_section_s m_sections[FONT_FILE_SECTIONS];
+} font_file_header_s;
+
+
+// loaded font file, font tables point into file mapping (or memory image), nothing is copied,
+// structure must not be moved while font is used (m_font points to m_huffman and m_compact)
+typedef struct {
+  packed_font_desc_s m_font;              // font desc to use
+  packed_huffman_s m_huffman;             // huffman code of font, if font has it
+  packed_compact_symbols_s m_compact;     // compact symbols table, if font has it
+  int m_max_symbol_width;                 // max x_advance of symbols
+  void * m_map;                           // file mapping, 0 for memory image
+  size_t m_map_size;                      // file mapping size
+} font_file_s;
+
+
+// map font file read only (pages are shared between processes), returns false if file is absent or bad
+bool font_file_open( font_file_s * a_file, const char * a_file_name );
+// use font file image in memory, a_data aligned to FONT_FILE_ALIGN and valid while font is used,
+// header, sections bounds and tables contents (symbols indexes, ranges order, huffman code, read ahead
+// padding of packed data) are checked once, packed data of each symbol is decoded once to check that it
+// ends within packed data and matches rows index, returns false if image is bad
+bool font_file_load_mem( font_file_s * a_file, const void * a_data, size_t a_size );
+// unmap font file
+void font_file_close( font_file_s * a_file );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FONT_BMP_FILE_H__
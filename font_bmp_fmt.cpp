@@ -0,0 +1,244 @@
+//
+#include <string.h>
+
+#include "font_bmp_fmt.h"
+
+
+// a_x / 7 without division, exact for 0 <= a_x <= 255 * 7
+#define DIV_BY_7(a_x) ((int)(((uint32_t)(a_x) * 9363u) >> 16))
+
+
+// pixel formats, pack() converts color once for palette, fill() writes run of pixels
+template <int F> struct pixel_format_s;
+
+
+// 16 bits formats, palette holds value with right bytes order in memory
+template <bool BE> struct pixel_format_rgb565_s {
+  static uint32_t pack( int r, int g, int b ) {
+    uint16_t v_c = (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | ((b & 0xF8) >> 3));
+    uint8_t v_bytes[2];
+    v_bytes[BE ? 1 : 0] = v_c & 0xFF;
+    v_bytes[BE ? 0 : 1] = v_c >> 8;
+    uint16_t v_result;
+    ::memcpy( &v_result, v_bytes, sizeof(v_result) );
+    return v_result;
+  }
+  static void fill( uint8_t * a_row, int a_x, int a_count, uint32_t a_color ) {
+    uint16_t v_c = (uint16_t)a_color;
+    for ( uint8_t * v_dst = a_row + a_x * 2; a_count > 0; --a_count, v_dst += 2 ) {
+      ::memcpy( v_dst, &v_c, sizeof(v_c) );
+    }
+  }
+};
+
+template <> struct pixel_format_s<PIXFMT_RGB565_LE> : pixel_format_rgb565_s<false> {};
+template <> struct pixel_format_s<PIXFMT_RGB565_BE> : pixel_format_rgb565_s<true> {};
+
+
+template <> struct pixel_format_s<PIXFMT_RGB888> {
+  static uint32_t pack( int r, int g, int b ) {
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+  }
+  static void fill( uint8_t * a_row, int a_x, int a_count, uint32_t a_color ) {
+    for ( uint8_t * v_dst = a_row + a_x * 3; a_count > 0; --a_count ) {
+      *v_dst++ = (uint8_t)(a_color >> 16);
+      *v_dst++ = (uint8_t)(a_color >> 8);
+      *v_dst++ = (uint8_t)a_color;
+    }
+  }
+};
+
+
+template <> struct pixel_format_s<PIXFMT_ARGB8888> {
+  static uint32_t pack( int r, int g, int b ) {
+    return 0xFF000000u | ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+  }
+  static void fill( uint8_t * a_row, int a_x, int a_count, uint32_t a_color ) {
+    for ( uint8_t * v_dst = a_row + a_x * 4; a_count > 0; --a_count, v_dst += 4 ) {
+      ::memcpy( v_dst, &a_color, sizeof(a_color) );
+    }
+  }
+};
+
+
+template <> struct pixel_format_s<PIXFMT_GRAY8> {
+  static uint32_t pack( int r, int g, int b ) {
+    return (uint32_t)((r * 77 + g * 150 + b * 29) >> 8);
+  }
+  static void fill( uint8_t * a_row, int a_x, int a_count, uint32_t a_color ) {
+    ::memset( a_row + a_x, (int)a_color, a_count );
+  }
+};
+
+
+template <> struct pixel_format_s<PIXFMT_MONO1> {
+  static uint32_t pack( int r, int g, int b ) {
+    return pixel_format_s<PIXFMT_GRAY8>::pack( r, g, b ) >= 128 ? 1 : 0;
+  }
+  static void fill( uint8_t * a_row, int a_x, int a_count, uint32_t a_color ) {
+    for ( ; a_count > 0; --a_count, ++a_x ) {
+      uint8_t v_bit = (uint8_t)(0x80 >> (a_x & 7));
+      if ( a_color ) {
+        a_row[a_x >> 3] |= v_bit;
+      } else {
+        a_row[a_x >> 3] &= (uint8_t)~v_bit;
+      }
+    }
+  }
+};
+
+
+template <int F> static void init_palette( display_palette_fmt_s * a_palette, uint32_t a_bgcolor, uint32_t a_fgcolor ) {
+  int v_bg_r = (a_bgcolor >> 16) & 0xFF;
+  int v_bg_g = (a_bgcolor >> 8) & 0xFF;
+  int v_bg_b = a_bgcolor & 0xFF;
+  int v_fg_r = (a_fgcolor >> 16) & 0xFF;
+  int v_fg_g = (a_fgcolor >> 8) & 0xFF;
+  int v_fg_b = a_fgcolor & 0xFF;
+  for ( int i = 0; i < 8; ++i ) {
+    a_palette->m_colors[i] = pixel_format_s<F>::pack(
+        DIV_BY_7(v_bg_r * (7 - i)) + DIV_BY_7(v_fg_r * i)
+      , DIV_BY_7(v_bg_g * (7 - i)) + DIV_BY_7(v_fg_g * i)
+      , DIV_BY_7(v_bg_b * (7 - i)) + DIV_BY_7(v_fg_b * i)
+      );
+  }
+}
+
+
+// decoded runs are written straight in output format up to x_advance, pixels beyond it are decoded
+// without writing; neighbouring runs of the same color (background of x offset too) are written at once
+template <int F> static bool char_row( display_char_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row, int a_x ) {
+  const packed_symbol_desc_s * v_symbol = a_data->m_symbol;
+  const uint32_t * v_colors = a_palette->m_colors;
+  uint8_t * v_row = (uint8_t *)a_dst_row;
+  int v_width = a_data->m_cols_count;
+  // pending run, starts as background
+  int v_run_begin = 0;
+  int v_run_color = 0;
+  int v_col = 0;
+  if ( a_data->m_row >= v_symbol->m_y_offset && a_data->m_row < a_data->m_last_row ) {
+    for ( v_col = v_symbol->m_x_offset; v_col < a_data->m_last_col; ) {
+      int v_count = display_char_next_run( a_data, a_data->m_last_col - v_col );
+      if ( a_data->m_curr_color != v_run_color && v_col < v_width ) {
+        if ( v_col > v_run_begin ) {
+          pixel_format_s<F>::fill( v_row, a_x + v_run_begin, v_col - v_run_begin, v_colors[v_run_color] );
+        }
+        v_run_begin = v_col;
+        v_run_color = a_data->m_curr_color;
+      }
+      v_col += v_count;
+    }
+  }
+  // pending run up to x_advance, then background
+  if ( 0 != v_run_color ) {
+    int v_end = v_col < v_width ? v_col : v_width;
+    pixel_format_s<F>::fill( v_row, a_x + v_run_begin, v_end - v_run_begin, v_colors[v_run_color] );
+    v_run_begin = v_end;
+  }
+  if ( v_run_begin < v_width ) {
+    pixel_format_s<F>::fill( v_row, a_x + v_run_begin, v_width - v_run_begin, v_colors[0] );
+  }
+  return ++a_data->m_row >= a_data->m_font->m_row_height;
+}
+
+
+template <int F> static bool line_row( display_line_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row ) {
+  int v_x = 0;
+  for ( int i = 0; i < a_data->m_chars_count; ++i ) {
+    char_row<F>( &(a_data->m_chars[i]), a_palette, a_dst_row, v_x );
+    v_x += a_data->m_chars[i].m_cols_count;
+  }
+  // background up to row width
+  if ( v_x < a_data->m_width ) {
+    pixel_format_s<F>::fill( (uint8_t *)a_dst_row, v_x, a_data->m_width - v_x, a_palette->m_colors[0] );
+  }
+  return ++a_data->m_row >= a_data->m_font->m_row_height;
+}
+
+
+// run-time dispatch tables, indexed by pixel_format_e
+typedef void (*init_palette_t)( display_palette_fmt_s *, uint32_t, uint32_t );
+typedef bool (*char_row_t)( display_char_s *, const display_palette_fmt_s *, void *, int );
+typedef bool (*line_row_t)( display_line_s *, const display_palette_fmt_s *, void * );
+
+static const init_palette_t g_init_palette[PIXFMT_COUNT] = {
+  init_palette<PIXFMT_RGB565_LE>
+, init_palette<PIXFMT_RGB565_BE>
+, init_palette<PIXFMT_RGB888>
+, init_palette<PIXFMT_ARGB8888>
+, init_palette<PIXFMT_GRAY8>
+, init_palette<PIXFMT_MONO1>
+};
+
+static const char_row_t g_char_row[PIXFMT_COUNT] = {
+  char_row<PIXFMT_RGB565_LE>
+, char_row<PIXFMT_RGB565_BE>
+, char_row<PIXFMT_RGB888>
+, char_row<PIXFMT_ARGB8888>
+, char_row<PIXFMT_GRAY8>
+, char_row<PIXFMT_MONO1>
+};
+
+static const line_row_t g_line_row[PIXFMT_COUNT] = {
+  line_row<PIXFMT_RGB565_LE>
+, line_row<PIXFMT_RGB565_BE>
+, line_row<PIXFMT_RGB888>
+, line_row<PIXFMT_ARGB8888>
+, line_row<PIXFMT_GRAY8>
+, line_row<PIXFMT_MONO1>
+};
+
+
+extern "C" {
+
+bool display_palette_fmt_init( display_palette_fmt_s * a_palette, int a_format, uint32_t a_bgcolor, uint32_t a_fgcolor ) {
+  bool v_result = a_format >= 0 && a_format < PIXFMT_COUNT;
+  if ( !v_result ) {
+    a_format = PIXFMT_RGB565_BE;
+  }
+  a_palette->m_format = a_format;
+  g_init_palette[a_format]( a_palette, a_bgcolor, a_fgcolor );
+  return v_result;
+}
+
+
+bool display_char_row_fmt( display_char_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row, int a_x ) {
+  return g_char_row[a_palette->m_format]( a_data, a_palette, a_dst_row, a_x );
+}
+
+
+bool display_line_row_fmt( display_line_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row ) {
+  return g_line_row[a_palette->m_format]( a_data, a_palette, a_dst_row );
+}
+
+
+bool display_char_row_rgb565le( display_char_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row, int a_x ) {
+  return char_row<PIXFMT_RGB565_LE>( a_data, a_palette, a_dst_row, a_x );
+}
+
+
+bool display_char_row_rgb565be( display_char_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row, int a_x ) {
+  return char_row<PIXFMT_RGB565_BE>( a_data, a_palette, a_dst_row, a_x );
+}
+
+
+bool display_char_row_rgb888( display_char_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row, int a_x ) {
+  return char_row<PIXFMT_RGB888>( a_data, a_palette, a_dst_row, a_x );
+}
+
+
+bool display_char_row_argb8888( display_char_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row, int a_x ) {
+  return char_row<PIXFMT_ARGB8888>( a_data, a_palette, a_dst_row, a_x );
+}
+
+
+bool display_char_row_gray8( display_char_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row, int a_x ) {
+  return char_row<PIXFMT_GRAY8>( a_data, a_palette, a_dst_row, a_x );
+}
+
+
+bool display_char_row_mono1( display_char_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row, int a_x ) {
+  return char_row<PIXFMT_MONO1>( a_data, a_palette, a_dst_row, a_x );
+}
+
+}
@@ -0,0 +1,50 @@
+#ifndef __FONT_BMP_FMT_H__
+#define __FONT_BMP_FMT_H__
+
+#include "font_bmp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// output pixel formats, pixels are written in order of bytes in memory
+typedef enum {
+  PIXFMT_RGB565_LE = 0,   // R5G6B5, low byte first
+  PIXFMT_RGB565_BE,       // R5G6B5, high byte first (same as display_char_row)
+  PIXFMT_RGB888,          // bytes R, G, B
+  PIXFMT_ARGB8888,        // native uint32_t 0xAARRGGBB, alpha is 0xFF
+  PIXFMT_GRAY8,           // one byte luma
+  PIXFMT_MONO1,           // one bit per pixel, most significant bit first, 1 - foreground
+  PIXFMT_COUNT
+} pixel_format_e;
+
+
+// colors palette in output pixel format, 8 colors scale from background to foreground
+typedef struct {
+  int m_format;                           // pixel_format_e
+  uint32_t m_colors[8];                   // colors ready to write
+} display_palette_fmt_s;
+
+
+// build palette for output format, a_bgcolor and a_fgcolor are 0xRRGGBB,
+// returns false for unknown format (palette is built for PIXFMT_RGB565_BE then)
+bool display_palette_fmt_init( display_palette_fmt_s * a_palette, int a_format, uint32_t a_bgcolor, uint32_t a_fgcolor );
+// prepare one row pixels of symbol at pixel a_x of a_dst_row, format from palette, returns true, if it was last row
+bool display_char_row_fmt( display_char_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row, int a_x );
+// prepare one full-width row of all symbols of line (a_data->m_pixbuf isn't used), returns true, if it was last row
+bool display_line_row_fmt( display_line_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row );
+
+// same as display_char_row_fmt, for one format without run-time dispatch
+bool display_char_row_rgb565le( display_char_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row, int a_x );
+bool display_char_row_rgb565be( display_char_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row, int a_x );
+bool display_char_row_rgb888( display_char_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row, int a_x );
+bool display_char_row_argb8888( display_char_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row, int a_x );
+bool display_char_row_gray8( display_char_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row, int a_x );
+bool display_char_row_mono1( display_char_s * a_data, const display_palette_fmt_s * a_palette, void * a_dst_row, int a_x );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FONT_BMP_FMT_H__
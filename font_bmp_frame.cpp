@@ -0,0 +1,266 @@
+//
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+
+#include <string.h>
+
+#include "font_bmp_frame.h"
+#include "font_bmp_simd.h"
+
+
+#define FRAME_BANDS_PER_THREAD  4
+// symbol row buffer, x_offset + width may exceed x_advance up to 255 pixels
+#define FRAME_ROW_BUFFER_SIZE   512
+
+
+// text line of label within bands it crosses
+struct frame_line_s {
+  const char * m_str;                     // first byte of line
+  int m_item;                             // label index
+  int m_y;                                // top of line within frame
+};
+
+
+// bands of one thread, owner takes bands from front, idle threads steal from back
+struct band_queue_s {
+  std::mutex m_lock;
+  std::deque<int> m_bands;
+};
+
+
+struct frame_renderer_s {
+  std::vector<std::thread> m_threads;     // pool threads, calling thread renders too
+  std::vector<band_queue_s> m_queues;     // one per rendering thread, [0] is calling thread's
+  std::mutex m_lock;
+  std::condition_variable m_start;
+  std::condition_variable m_done;
+  uint64_t m_frame;                       // frame number, pool threads start when it changes
+  int m_busy;                             // pool threads within current frame
+  bool m_stop;
+  int m_band_height;                      // requested band height, 0 - auto
+  // current frame
+  const frame_item_s * m_items;
+  std::vector<display_palette_s> m_palettes;          // palette of each label
+  std::vector<std::vector<frame_line_s> > m_bands;    // lines crossing each band
+  int m_curr_band_height;
+  uint16_t * m_pixels;
+  int m_width;
+  int m_height;
+  int m_stride;
+  frame_renderer_s( int a_threads )
+    : m_queues(a_threads)
+    , m_frame(0)
+    , m_busy(0)
+    , m_stop(false)
+    , m_band_height(0)
+    , m_items(0)
+    , m_curr_band_height(0)
+    , m_pixels(0)
+    , m_width(0)
+    , m_height(0)
+    , m_stride(0)
+    {}
+};
+
+
+// rasterize rows of band, symbols rows out of band aren't decoded
+static void render_band( frame_renderer_s * a_renderer, int a_band ) {
+  uint16_t v_row[FRAME_ROW_BUFFER_SIZE];
+  display_char_s v_char;
+  int v_top = a_band * a_renderer->m_curr_band_height;
+  int v_bottom = std::min( v_top + a_renderer->m_curr_band_height, a_renderer->m_height );
+  int v_width = a_renderer->m_width;
+  for ( const frame_line_s & v_line: a_renderer->m_bands[a_band] ) {
+    const frame_item_s & v_item = a_renderer->m_items[v_line.m_item];
+    const packed_font_desc_s * v_font = v_item.m_font;
+    // symbol rows within band
+    int v_first = std::max( v_top, v_line.m_y ) - v_line.m_y;
+    int v_last = std::min( v_bottom, v_line.m_y + v_font->m_row_height ) - v_line.m_y;
+    uint16_t * v_dst_line = a_renderer->m_pixels + (ptrdiff_t)(v_line.m_y + v_first) * a_renderer->m_stride;
+    int v_x = v_item.m_x;
+    const char * v_str = v_line.m_str;
+    for ( uint32_t c = get_next_utf8_code( &v_str ); 0 != c && '\n' != c && v_x < v_width; c = get_next_utf8_code( &v_str ) ) {
+      if ( '\r' == c ) {
+        continue;
+      }
+      display_char_init_pal( &v_char, c, v_font, v_row, &(a_renderer->m_palettes[v_line.m_item]) );
+      int v_cols = v_char.m_cols_count;
+      if ( v_x + v_cols > 0 ) {
+        if ( v_first > 0 ) {
+          display_char_seek_row( &v_char, v_first );
+        }
+        uint16_t * v_dst = v_dst_line + v_x;
+        if ( v_x >= 0 && v_x + std::max( v_cols, v_char.m_last_col ) <= v_width ) {
+          // whole symbol row within frame, decode in place
+          for ( int y = v_first; y < v_last; ++y, v_dst += a_renderer->m_stride ) {
+            v_char.m_pixbuf = v_dst;
+            display_char_row_fast( &v_char );
+          }
+        } else {
+          // clipped by frame edge
+          int v_skip = v_x < 0 ? -v_x : 0;
+          int v_count = std::min( v_cols, v_width - v_x ) - v_skip;
+          for ( int y = v_first; y < v_last; ++y, v_dst += a_renderer->m_stride ) {
+            display_char_row_fast( &v_char );
+            ::memcpy( v_dst + v_skip, v_row + v_skip, v_count * sizeof(uint16_t) );
+          }
+        }
+      }
+      v_x += v_cols;
+    }
+  }
+}
+
+
+// render own bands, then steal bands of other threads while any left
+static void render_bands( frame_renderer_s * a_renderer, int a_index ) {
+  int v_queues = (int)a_renderer->m_queues.size();
+  for ( ;; ) {
+    int v_band = -1;
+    {
+      band_queue_s & v_own = a_renderer->m_queues[a_index];
+      std::lock_guard<std::mutex> v_guard( v_own.m_lock );
+      if ( !v_own.m_bands.empty() ) {
+        v_band = v_own.m_bands.front();
+        v_own.m_bands.pop_front();
+      }
+    }
+    for ( int i = 1; v_band < 0 && i < v_queues; ++i ) {
+      band_queue_s & v_other = a_renderer->m_queues[(a_index + i) % v_queues];
+      std::lock_guard<std::mutex> v_guard( v_other.m_lock );
+      if ( !v_other.m_bands.empty() ) {
+        v_band = v_other.m_bands.back();
+        v_other.m_bands.pop_back();
+      }
+    }
+    if ( v_band < 0 ) {
+      // no bands are added during frame
+      return;
+    }
+    render_band( a_renderer, v_band );
+  }
+}
+
+
+static void pool_thread( frame_renderer_s * a_renderer, int a_index ) {
+  uint64_t v_frame = 0;
+  for ( ;; ) {
+    {
+      std::unique_lock<std::mutex> v_lock( a_renderer->m_lock );
+      a_renderer->m_start.wait( v_lock, [&]() { return a_renderer->m_stop || a_renderer->m_frame != v_frame; } );
+      if ( a_renderer->m_stop ) {
+        return;
+      }
+      v_frame = a_renderer->m_frame;
+    }
+    render_bands( a_renderer, a_index );
+    {
+      std::lock_guard<std::mutex> v_guard( a_renderer->m_lock );
+      if ( 0 == --a_renderer->m_busy ) {
+        a_renderer->m_done.notify_all();
+      }
+    }
+  }
+}
+
+
+frame_renderer_s * frame_renderer_create( int a_threads, int a_band_height ) {
+  if ( a_threads <= 0 ) {
+    a_threads = std::max( 1, (int)std::thread::hardware_concurrency() );
+  }
+  frame_renderer_s * v_result = new frame_renderer_s( a_threads );
+  v_result->m_band_height = std::max( 0, a_band_height );
+  for ( int i = 1; i < a_threads; ++i ) {
+    v_result->m_threads.emplace_back( pool_thread, v_result, i );
+  }
+  return v_result;
+}
+
+
+void frame_renderer_destroy( frame_renderer_s * a_renderer ) {
+  {
+    std::lock_guard<std::mutex> v_guard( a_renderer->m_lock );
+    a_renderer->m_stop = true;
+  }
+  a_renderer->m_start.notify_all();
+  for ( std::thread & v_thread: a_renderer->m_threads ) {
+    v_thread.join();
+  }
+  delete a_renderer;
+}
+
+
+void frame_renderer_draw( frame_renderer_s * a_renderer, const frame_item_s * a_items, int a_items_count, uint16_t * a_frame, int a_width, int a_height, int a_stride ) {
+  if ( a_width <= 0 || a_height <= 0 || a_items_count <= 0 ) {
+    return;
+  }
+  int v_queues = (int)a_renderer->m_queues.size();
+  int v_band_height = a_renderer->m_band_height;
+  if ( 0 == v_band_height ) {
+    int v_bands = v_queues * FRAME_BANDS_PER_THREAD;
+    v_band_height = (a_height + v_bands - 1) / v_bands;
+  }
+  int v_bands_count = (a_height + v_band_height - 1) / v_band_height;
+  a_renderer->m_items = a_items;
+  a_renderer->m_curr_band_height = v_band_height;
+  a_renderer->m_pixels = a_frame;
+  a_renderer->m_width = a_width;
+  a_renderer->m_height = a_height;
+  a_renderer->m_stride = a_stride;
+  // place lines of labels into bands they cross
+  a_renderer->m_palettes.resize( a_items_count );
+  if ( (int)a_renderer->m_bands.size() < v_bands_count ) {
+    a_renderer->m_bands.resize( v_bands_count );
+  }
+  for ( int b = 0; b < v_bands_count; ++b ) {
+    a_renderer->m_bands[b].clear();
+  }
+  for ( int i = 0; i < a_items_count; ++i ) {
+    const frame_item_s & v_item = a_items[i];
+    if ( !v_item.m_str || !v_item.m_font ) {
+      continue;
+    }
+    display_palette_init( &(a_renderer->m_palettes[i]), v_item.m_bgcolor, v_item.m_fgcolor );
+    int v_row_height = v_item.m_font->m_row_height;
+    int v_y = v_item.m_y;
+    for ( const char * v_str = v_item.m_str; v_str && v_y < a_height; v_y += v_row_height ) {
+      if ( v_y + v_row_height > 0 && v_item.m_x < a_width ) {
+        frame_line_s v_line;
+        v_line.m_str = v_str;
+        v_line.m_item = i;
+        v_line.m_y = v_y;
+        int v_last_band = std::min( a_height - 1, v_y + v_row_height - 1 ) / v_band_height;
+        for ( int b = std::max( 0, v_y ) / v_band_height; b <= v_last_band; ++b ) {
+          a_renderer->m_bands[b].push_back( v_line );
+        }
+      }
+      v_str = ::strchr( v_str, '\n' );
+      if ( v_str ) {
+        ++v_str;
+      }
+    }
+  }
+  // neighbouring bands to the same thread
+  for ( int q = 0; q < v_queues; ++q ) {
+    band_queue_s & v_queue = a_renderer->m_queues[q];
+    std::lock_guard<std::mutex> v_guard( v_queue.m_lock );
+    v_queue.m_bands.clear();
+    for ( int b = (int)((int64_t)v_bands_count * q / v_queues); b < (int)((int64_t)v_bands_count * (q + 1) / v_queues); ++b ) {
+      v_queue.m_bands.push_back( b );
+    }
+  }
+  // start pool threads and render with them
+  {
+    std::lock_guard<std::mutex> v_guard( a_renderer->m_lock );
+    a_renderer->m_busy = (int)a_renderer->m_threads.size();
+    ++a_renderer->m_frame;
+  }
+  a_renderer->m_start.notify_all();
+  render_bands( a_renderer, 0 );
+  std::unique_lock<std::mutex> v_lock( a_renderer->m_lock );
+  a_renderer->m_done.wait( v_lock, [&]() { return 0 == a_renderer->m_busy; } );
+}
@@ -0,0 +1,42 @@
+#ifndef __FONT_BMP_FRAME_H__
+#define __FONT_BMP_FRAME_H__
+
+#include "font_bmp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// label of frame, text lines (up to LF) are placed one under other from m_x, m_y
+typedef struct {
+  const char * m_str;                     // text, utf-8
+  const packed_font_desc_s * m_font;      // font desc ptr
+  int m_x;                                // left of label within frame, may be negative
+  int m_y;                                // top of label within frame, may be negative
+  uint16_t m_bgcolor;                     // background color
+  uint16_t m_fgcolor;                     // foreground color
+} frame_item_s;
+
+
+// frame renderer for host side: frame is split into horizontal bands,
+// bands are rasterized by pool of threads, idle threads steal bands of busy ones,
+// each band decodes only rows of symbols within band (fonts with rows index seek fastest)
+typedef struct frame_renderer_s frame_renderer_s;
+
+
+// create renderer, a_threads - rendering threads with calling one (0 - hardware concurrency),
+// a_band_height - band height in pixels (0 - four bands per thread)
+frame_renderer_s * frame_renderer_create( int a_threads, int a_band_height );
+// stop threads and destroy renderer
+void frame_renderer_destroy( frame_renderer_s * a_renderer );
+// render labels into a_frame, a_width * a_height pixels with a_stride pixels per row,
+// byte swapped R5G6B5 as display_char_row, symbols are clipped by frame, pixels out of labels are kept,
+// returns when frame is ready, items and strings must be valid until return
+void frame_renderer_draw( frame_renderer_s * a_renderer, const frame_item_s * a_items, int a_items_count, uint16_t * a_frame, int a_width, int a_height, int a_stride );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FONT_BMP_FRAME_H__
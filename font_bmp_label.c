@@ -0,0 +1,111 @@
+#include "font_bmp_label.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// init label, nothing is displayed yet
+void label_init( label_s * a_label, const packed_font_desc_s * a_font, int a_x, int a_y, label_glyph_s * a_glyphs, int a_glyphs_max ) {
+  a_label->m_font = a_font;
+  a_label->m_x = a_x;
+  a_label->m_y = a_y;
+  a_label->m_glyphs = a_glyphs;
+  a_label->m_glyphs_max = a_glyphs_max;
+  a_label->m_glyphs_count = 0;
+  a_label->m_width = 0;
+  a_label->m_bgcolor = 0;
+  a_label->m_fgcolor = 0;
+  a_label->m_valid = false;
+}
+
+
+// output all rows of symbol at a_x within label
+static void output_symbol( label_s * a_label, display_char_s * a_char, int a_x, label_output_t a_output, void * a_ctx ) {
+  label_rect_s v_rect;
+  v_rect.m_x = a_label->m_x + a_x;
+  v_rect.m_y = a_label->m_y;
+  v_rect.m_width = a_char->m_cols_count;
+  v_rect.m_height = a_label->m_font->m_row_height;
+  for ( int v_row = 0; v_row < v_rect.m_height; ++v_row ) {
+    display_char_row( a_char );
+    a_output( a_ctx, &v_rect, v_row, a_char->m_pixbuf );
+  }
+}
+
+
+// fill label from a_x up to a_end by background, returns output rectangles count
+static int output_background( label_s * a_label, int a_x, int a_end, uint16_t a_color, uint16_t * a_row_buf, label_output_t a_output, void * a_ctx ) {
+  int v_result = 0;
+  label_rect_s v_rect;
+  v_rect.m_y = a_label->m_y;
+  v_rect.m_height = a_label->m_font->m_row_height;
+  for ( int i = 0; i < LABEL_ROW_BUFFER_SIZE && i < a_end - a_x; ++i ) {
+    a_row_buf[i] = a_color;
+  }
+  // by row buffer width
+  for ( ; a_x < a_end; a_x += v_rect.m_width, ++v_result ) {
+    v_rect.m_x = a_label->m_x + a_x;
+    v_rect.m_width = (a_end - a_x) < LABEL_ROW_BUFFER_SIZE ? (a_end - a_x) : LABEL_ROW_BUFFER_SIZE;
+    for ( int v_row = 0; v_row < v_rect.m_height; ++v_row ) {
+      a_output( a_ctx, &v_rect, v_row, a_row_buf );
+    }
+  }
+  return v_result;
+}
+
+
+// set text and colors, output changed symbols
+int label_update( label_s * a_label, const char * a_str, uint16_t a_bgcolor, uint16_t a_fgcolor, uint16_t * a_row_buf, label_output_t a_output, void * a_ctx ) {
+  display_palette_s v_palette;
+  display_char_s v_char;
+  int v_result = 0;
+  int v_x = 0;
+  int v_count = 0;
+  bool v_all = !a_label->m_valid || a_bgcolor != a_label->m_bgcolor || a_fgcolor != a_label->m_fgcolor;
+  display_palette_init( &v_palette, a_bgcolor, a_fgcolor );
+  for ( uint32_t c = get_next_utf8_code( &a_str ); 0 != c && '\n' != c; c = get_next_utf8_code( &a_str ) ) {
+    if ( '\r' == c ) {
+      continue;
+    }
+    if ( v_count >= a_label->m_glyphs_max ) {
+      break;
+    }
+    display_char_init_pal( &v_char, c, a_label->m_font, a_row_buf, &v_palette );
+    label_glyph_s * v_glyph = &(a_label->m_glyphs[v_count]);
+    // same symbol at same place has same width, it is on screen already
+    if ( v_all
+      || v_count >= a_label->m_glyphs_count
+      || v_glyph->m_code != v_char.m_symbol->m_code
+      || v_glyph->m_x != v_x ) {
+      v_glyph->m_code = v_char.m_symbol->m_code;
+      v_glyph->m_x = v_x;
+      output_symbol( a_label, &v_char, v_x, a_output, a_ctx );
+      ++v_result;
+    }
+    v_x += v_char.m_cols_count;
+    ++v_count;
+  }
+  // rest of previous longer text
+  if ( a_label->m_valid && a_label->m_width > v_x ) {
+    v_result += output_background( a_label, v_x, a_label->m_width, v_palette.m_colors[0], a_row_buf, a_output, a_ctx );
+  }
+  a_label->m_glyphs_count = v_count;
+  a_label->m_width = v_x;
+  a_label->m_bgcolor = a_bgcolor;
+  a_label->m_fgcolor = a_fgcolor;
+  a_label->m_valid = true;
+  return v_result;
+}
+
+
+// forget displayed symbols
+void label_invalidate( label_s * a_label ) {
+  a_label->m_glyphs_count = 0;
+  a_label->m_width = 0;
+  a_label->m_valid = false;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
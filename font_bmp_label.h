@@ -0,0 +1,66 @@
+#ifndef __FONT_BMP_LABEL_H__
+#define __FONT_BMP_LABEL_H__
+
+#include "font_bmp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// minimal pixels row buffer for label_update, symbol row is decoded up to max(x_advance, x_offset + width),
+// up to 510 pixels
+#define LABEL_ROW_BUFFER_SIZE 512
+
+
+// displayed symbol of label
+typedef struct {
+  uint32_t m_code;                        // code of displayed symbol (default symbol code for absent codes)
+  int m_x;                                // x within label
+} label_glyph_s;
+
+
+// screen rectangle
+typedef struct {
+  int m_x;
+  int m_y;
+  int m_width;
+  int m_height;
+} label_rect_s;
+
+
+// output of dirty rectangle row by row, a_row from 0 (set panel window here) up to a_rect->m_height - 1,
+// a_pixels - a_rect->m_width byte swapped R5G6B5 pixels
+typedef void (*label_output_t)( void * a_ctx, const label_rect_s * a_rect, int a_row, const uint16_t * a_pixels );
+
+
+// retained label, one text line, remembers displayed symbols to redraw only changed ones
+typedef struct {
+  const packed_font_desc_s * m_font;      // font desc ptr
+  int m_x;                                // left of label on screen
+  int m_y;                                // top of label on screen
+  label_glyph_s * m_glyphs;               // displayed symbols, caller memory
+  int m_glyphs_max;                       // room for symbols, symbols after it are dropped
+  int m_glyphs_count;                     // displayed symbols count
+  int m_width;                            // displayed width in pixels
+  uint16_t m_bgcolor;                     // displayed background color
+  uint16_t m_fgcolor;                     // displayed foreground color
+  bool m_valid;                           // label is on screen
+} label_s;
+
+
+// init label, nothing is displayed yet
+void label_init( label_s * a_label, const packed_font_desc_s * a_font, int a_x, int a_y, label_glyph_s * a_glyphs, int a_glyphs_max );
+// set text (up to LF) and colors, symbols with other code or place than displayed ones are output
+// as own rectangles, space after shorter text is filled by background, whole label is output
+// after colors change or label_invalidate; a_row_buf - LABEL_ROW_BUFFER_SIZE pixels,
+// returns output rectangles count
+int label_update( label_s * a_label, const char * a_str, uint16_t a_bgcolor, uint16_t a_fgcolor, uint16_t * a_row_buf, label_output_t a_output, void * a_ctx );
+// forget displayed symbols (screen was cleared), next label_update outputs whole label
+void label_invalidate( label_s * a_label );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FONT_BMP_LABEL_H__
@@ -0,0 +1,251 @@
+#include "font_bmp_layout.h"
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ELLIPSIS_CODE     0x2026
+#define ELLIPSIS_UTF8     "\xE2\x80\xA6"
+#define ELLIPSIS_DOTS     "..."
+
+
+static int get_code_width( const packed_font_desc_s * a_font, uint32_t a_code ) {
+  packed_symbol_desc_s v_buf;
+  return get_symbol_desc_buf( a_font, a_code, &v_buf )->m_x_advance;
+}
+
+
+// get width of symbols from a_begin up to a_end
+static int get_span_width( const packed_font_desc_s * a_font, const char * a_begin, const char * a_end ) {
+  int v_width = 0;
+  while ( a_begin < a_end ) {
+    v_width += get_code_width( a_font, get_next_utf8_code( &a_begin ) );
+  }
+  return v_width;
+}
+
+
+// find end of symbols from a_begin up to a_end, fitting into a_width, but at least one symbol
+static const char * fit_span( const packed_font_desc_s * a_font, const char * a_begin, const char * a_end, int a_width, int * a_fit_width ) {
+  const char * v_result = a_begin;
+  int v_width = 0;
+  while ( v_result < a_end ) {
+    const char * v_next = v_result;
+    int v_code_width = get_code_width( a_font, get_next_utf8_code( &v_next ) );
+    if ( v_width + v_code_width > a_width && v_result != a_begin ) {
+      break;
+    }
+    v_width += v_code_width;
+    v_result = v_next;
+  }
+  *a_fit_width = v_width;
+  return v_result;
+}
+
+
+void text_layout_init( text_layout_s * a_layout, const packed_font_desc_s * a_font, const char * a_str, void * a_arena, size_t a_arena_size ) {
+  a_layout->m_font = a_font;
+  a_layout->m_words = (text_word_s *)a_arena;
+  a_layout->m_words_count = 0;
+  a_layout->m_lines_count = 0;
+  a_layout->m_words_truncated = false;
+  a_layout->m_width = 0;
+  a_layout->m_height = 0;
+  // ellipsis
+  packed_symbol_desc_s v_buf;
+  if ( ELLIPSIS_CODE == get_symbol_desc_buf( a_font, ELLIPSIS_CODE, &v_buf )->m_code ) {
+    a_layout->m_ellipsis = ELLIPSIS_UTF8;
+  } else {
+    a_layout->m_ellipsis = ELLIPSIS_DOTS;
+  }
+  a_layout->m_ellipsis_width = get_span_width( a_font, a_layout->m_ellipsis, a_layout->m_ellipsis + strlen( a_layout->m_ellipsis ) );
+  // words, room for one line at least
+  int v_words_max = 0;
+  if ( a_arena_size > sizeof(text_line_s) ) {
+    v_words_max = (int)((a_arena_size - sizeof(text_line_s)) / sizeof(text_word_s));
+  }
+  int v_space_width = get_code_width( a_font, ' ' );
+  text_word_s * v_word = 0;
+  for ( ;; ) {
+    const char * v_pos = a_str;
+    uint32_t c = get_next_utf8_code( &a_str );
+    if ( 0 == c ) {
+      break;
+    }
+    if ( '\r' == c ) {
+      continue;
+    }
+    bool v_space = (' ' == c || '\t' == c);
+    bool v_newline = ('\n' == c);
+    // next word starts at symbol after spaces or LF, at spaces or LF after LF, at text begin
+    if ( !v_word
+      || v_word->m_newline
+      || (!v_space && !v_newline && v_word->m_space_width > 0) ) {
+      if ( a_layout->m_words_count >= v_words_max ) {
+        a_layout->m_words_truncated = true;
+        break;
+      }
+      v_word = &(a_layout->m_words[a_layout->m_words_count++]);
+      v_word->m_begin = v_pos;
+      v_word->m_end = v_pos;
+      v_word->m_width = 0;
+      v_word->m_space_width = 0;
+      v_word->m_newline = false;
+    }
+    if ( v_newline ) {
+      v_word->m_newline = true;
+    } else if ( v_space ) {
+      v_word->m_space_width += v_space_width;
+    } else {
+      v_word->m_width += get_code_width( a_font, c );
+      v_word->m_end = a_str;
+    }
+  }
+  // rest of arena for lines
+  char * v_lines = (char *)(a_layout->m_words + a_layout->m_words_count);
+  size_t v_align = sizeof(void *);
+  size_t v_skip = (v_align - ((uintptr_t)v_lines % v_align)) % v_align;
+  size_t v_used = (size_t)(v_lines - (char *)a_arena) + v_skip;
+  a_layout->m_lines = (text_line_s *)(v_lines + v_skip);
+  a_layout->m_lines_max = v_used < a_arena_size ? (int)((a_arena_size - v_used) / sizeof(text_line_s)) : 0;
+}
+
+
+// add line, returns false, if no more room for lines
+static bool add_line( text_layout_s * a_layout, int a_max_lines, const char * a_begin, const char * a_end, int a_width ) {
+  if ( a_layout->m_lines_count >= a_layout->m_lines_max ) {
+    return false;
+  }
+  text_line_s * v_line = &(a_layout->m_lines[a_layout->m_lines_count]);
+  v_line->m_begin = a_begin;
+  v_line->m_end = a_end;
+  v_line->m_y = a_layout->m_lines_count * a_layout->m_font->m_row_height;
+  v_line->m_width = a_width;
+  v_line->m_ellipsis = false;
+  ++a_layout->m_lines_count;
+  return a_layout->m_lines_count < a_max_lines;
+}
+
+
+// truncate line to fit it with ellipsis into box
+static void set_ellipsis( text_layout_s * a_layout, text_line_s * a_line, int a_box_width ) {
+  int v_width;
+  const char * v_end = fit_span( a_layout->m_font, a_line->m_begin, a_line->m_end, a_box_width - a_layout->m_ellipsis_width, &v_width );
+  // no one symbol fits with ellipsis
+  if ( v_width + a_layout->m_ellipsis_width > a_box_width ) {
+    v_end = a_line->m_begin;
+    v_width = 0;
+  }
+  a_line->m_end = v_end;
+  a_line->m_width = v_width + a_layout->m_ellipsis_width;
+  a_line->m_ellipsis = true;
+}
+
+
+int text_layout_run( text_layout_s * a_layout, const text_layout_params_s * a_params ) {
+  int v_box = a_params->m_width;
+  int v_max_lines = a_layout->m_lines_max;
+  if ( a_params->m_max_lines > 0 && a_params->m_max_lines < v_max_lines ) {
+    v_max_lines = a_params->m_max_lines;
+  }
+  a_layout->m_lines_count = 0;
+  a_layout->m_width = 0;
+  a_layout->m_height = 0;
+  // no room for lines, arena too small
+  if ( a_layout->m_lines_max <= 0 ) {
+    return 0;
+  }
+  bool v_more = true;                     // room for next line
+  bool v_truncated = false;               // text left after last line
+  bool v_started = false;                 // current line has text
+  const char * v_begin = 0;               // current line begin
+  const char * v_end = 0;                 // current line end, without trailing spaces
+  int v_width = 0;                        // current line width, without trailing spaces
+  int v_pending = 0;                      // trailing spaces width
+  int i = 0;
+  for ( ; v_more && i < a_layout->m_words_count; ++i ) {
+    const text_word_s * v_word = &(a_layout->m_words[i]);
+    const char * v_word_begin = v_word->m_begin;
+    int v_word_width = v_word->m_width;
+    for ( ;; ) {
+      if ( v_started && a_params->m_wrap && (v_width + v_pending + v_word_width) > v_box ) {
+        // wrap before word, spaces between words are dropped
+        v_started = false;
+        v_more = add_line( a_layout, v_max_lines, v_begin, v_end, v_width );
+        if ( !v_more ) {
+          v_truncated = true;
+          break;
+        }
+      }
+      if ( !v_started ) {
+        v_started = true;
+        v_begin = v_word_begin;
+        v_end = v_word_begin;
+        v_width = 0;
+        v_pending = 0;
+      }
+      if ( a_params->m_wrap && v_word_width > 0 && (v_width + v_pending + v_word_width) > v_box ) {
+        // word wider than box, break it between symbols
+        int v_fit_width;
+        const char * v_split = fit_span( a_layout->m_font, v_word_begin, v_word->m_end, v_box - v_width - v_pending, &v_fit_width );
+        v_started = false;
+        v_more = add_line( a_layout, v_max_lines, v_begin, v_split, v_width + v_pending + v_fit_width );
+        if ( !v_more ) {
+          v_truncated = true;
+          break;
+        }
+        v_word_begin = v_split;
+        v_word_width -= v_fit_width;
+        continue;
+      }
+      v_width += v_pending + v_word_width;
+      v_end = v_word->m_end;
+      v_pending = v_word->m_space_width;
+      break;
+    }
+    if ( v_more && v_word->m_newline ) {
+      v_started = false;
+      v_more = add_line( a_layout, v_max_lines, v_begin, v_end, v_width );
+    }
+  }
+  if ( v_more && v_started ) {
+    add_line( a_layout, v_max_lines, v_begin, v_end, v_width );
+  }
+  if ( i < a_layout->m_words_count || a_layout->m_words_truncated ) {
+    v_truncated = true;
+  }
+  // ellipsis, alignment and extent
+  a_layout->m_width = 0;
+  for ( int j = 0; j < a_layout->m_lines_count; ++j ) {
+    text_line_s * v_line = &(a_layout->m_lines[j]);
+    if ( a_params->m_ellipsis
+      && (v_line->m_width > v_box || (v_truncated && j == a_layout->m_lines_count - 1)) ) {
+      set_ellipsis( a_layout, v_line, v_box );
+    }
+    switch ( a_params->m_align ) {
+      case TEXT_ALIGN_CENTER:
+        v_line->m_x = (v_box - v_line->m_width) / 2;
+        break;
+      case TEXT_ALIGN_RIGHT:
+        v_line->m_x = v_box - v_line->m_width;
+        break;
+      default:
+        v_line->m_x = 0;
+        break;
+    }
+    if ( v_line->m_x < 0 ) {
+      v_line->m_x = 0;
+    }
+    if ( v_line->m_width > a_layout->m_width ) {
+      a_layout->m_width = v_line->m_width;
+    }
+  }
+  a_layout->m_height = a_layout->m_lines_count * a_layout->m_font->m_row_height;
+  return a_layout->m_lines_count;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
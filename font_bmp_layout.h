@@ -0,0 +1,75 @@
+#ifndef __FONT_BMP_LAYOUT_H__
+#define __FONT_BMP_LAYOUT_H__
+
+#include <stddef.h>
+
+#include "font_bmp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TEXT_ALIGN_LEFT     0
+#define TEXT_ALIGN_CENTER   1
+#define TEXT_ALIGN_RIGHT    2
+
+
+// measured word, symbols up to space or LF
+typedef struct {
+  const char * m_begin;                   // first byte of word
+  const char * m_end;                     // byte after last symbol of word
+  int m_width;                            // width in pixels of word symbols
+  int m_space_width;                      // width in pixels of spaces after word
+  bool m_newline;                         // LF after spaces
+} text_word_s;
+
+
+// text line after layout
+typedef struct {
+  const char * m_begin;                   // first byte of line text
+  const char * m_end;                     // byte after last symbol, trailing spaces excluded
+  int m_x;                                // pen position of line, alignment applied
+  int m_y;                                // top of line
+  int m_width;                            // width in pixels, with ellipsis
+  bool m_ellipsis;                        // text truncated, display m_ellipsis of layout after m_end
+} text_line_s;
+
+
+// layout parameters
+typedef struct {
+  int m_width;                            // box width in pixels
+  int m_max_lines;                        // lines limit, 0 - no limit
+  int m_align;                            // TEXT_ALIGN_...
+  bool m_wrap;                            // break lines between words, else at LF only
+  bool m_ellipsis;                        // truncate last line with ellipsis, if text doesn't fit
+} text_layout_params_s;
+
+
+// text layout, words are measured once and reused by each text_layout_run
+typedef struct {
+  const packed_font_desc_s * m_font;      // font desc ptr
+  text_word_s * m_words;                  // words, at begin of arena
+  int m_words_count;                      // measured words
+  text_line_s * m_lines;                  // lines, at end of arena
+  int m_lines_max;                        // room for lines
+  int m_lines_count;                      // lines after last layout
+  bool m_words_truncated;                 // arena too small, text after last word was dropped
+  const char * m_ellipsis;                // ellipsis string, U+2026 if font has it, else "..."
+  int m_ellipsis_width;                   // width in pixels of ellipsis
+  int m_width;                            // width of text after last layout
+  int m_height;                           // height of text after last layout
+} text_layout_s;
+
+
+// measure words of a_str, no heap used: words and lines are placed in a_arena,
+// a_arena must be aligned for pointers (as malloc gives), too small arena gives no lines
+void text_layout_init( text_layout_s * a_layout, const packed_font_desc_s * a_font, const char * a_str, void * a_arena, size_t a_arena_size );
+// break text into lines, returns lines count, may be called many times with other parameters
+int text_layout_run( text_layout_s * a_layout, const text_layout_params_s * a_params );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FONT_BMP_LAYOUT_H__
@@ -0,0 +1,184 @@
+#include "font_bmp_scale.h"
+
+#include <limits.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// scale within SCALE_MIN..SCALE_MAX
+static int clamp_scale( int a_scale ) {
+  if ( a_scale < SCALE_MIN ) {
+    return SCALE_MIN;
+  }
+  return a_scale > SCALE_MAX ? SCALE_MAX : a_scale;
+}
+
+
+// prepare to display scaled symbol
+void display_char_init_scaled( display_char_scaled_s * a_data, uint32_t a_code, const packed_font_desc_s * a_font, uint16_t * a_dst_row, const display_palette_s * a_palette, int a_scale, bool a_smooth ) {
+  a_scale = clamp_scale( a_scale );
+  display_char_init_pal( &(a_data->m_src), a_code, a_font, 0, a_palette );
+  a_data->m_upper = 0;
+  // no source row is decoded yet
+  a_data->m_upper_row = INT_MIN;
+  a_data->m_pixbuf = a_dst_row;
+  a_data->m_cols_count = a_data->m_src.m_cols_count * a_scale;
+  a_data->m_row = 0;
+  a_data->m_rows_count = a_font->m_row_height * a_scale;
+  a_data->m_scale = a_scale;
+  a_data->m_smooth = a_smooth;
+}
+
+
+// first source pixel and 1/(2*a_scale) fraction from it to next one for scaled pixel a_pos,
+// scaled pixel center is mapped into source pixels centers
+static int scaled_source_pos( int a_pos, int a_scale, int * a_frac ) {
+  int v_pos = 2 * a_pos + 1 - a_scale;
+  int v_result = v_pos >= 0 ? v_pos / (2 * a_scale) : -1;
+  *a_frac = v_pos - v_result * 2 * a_scale;
+  return v_result;
+}
+
+
+// replicated source row shades into scaled pixels
+static void expand_row( const display_char_scaled_s * a_data, const uint8_t * a_shades ) {
+  const uint16_t * v_colors = a_data->m_src.m_colors;
+  uint16_t * v_dst = a_data->m_pixbuf;
+  int v_count = a_data->m_src.m_cols_count;
+  for ( int x = 0; x < v_count; ++x ) {
+    uint16_t v_color = v_colors[a_shades[x]];
+    for ( int i = 0; i < a_data->m_scale; ++i ) {
+      *v_dst++ = v_color;
+    }
+  }
+}
+
+
+// bilinear interpolation of two source rows shades into scaled pixels, a_frac - weight of a_lower
+// in 1/(2*scale) parts, shades outside of symbol place are background
+static void interpolate_row( const display_char_scaled_s * a_data, const uint8_t * a_upper, const uint8_t * a_lower, int a_frac ) {
+  const uint16_t * v_colors = a_data->m_src.m_colors;
+  uint16_t * v_dst = a_data->m_pixbuf;
+  int v_count = a_data->m_src.m_cols_count;
+  int v_scale2 = 2 * a_data->m_scale;
+  int v_round = v_scale2 * v_scale2 / 2;
+  int v_frac;
+  int v_x = scaled_source_pos( 0, a_data->m_scale, &v_frac );
+  for ( int x = 0; x < a_data->m_cols_count; ++x ) {
+    int v_left = v_x >= 0 ? (v_scale2 - a_frac) * a_upper[v_x] + a_frac * a_lower[v_x] : 0;
+    int v_right = v_x + 1 < v_count ? (v_scale2 - a_frac) * a_upper[v_x + 1] + a_frac * a_lower[v_x + 1] : 0;
+    *v_dst++ = v_colors[((v_scale2 - v_frac) * v_left + v_frac * v_right + v_round) / (v_scale2 * v_scale2)];
+    // next scaled pixel center is 2 parts right
+    v_frac += 2;
+    if ( v_frac >= v_scale2 ) {
+      v_frac -= v_scale2;
+      ++v_x;
+    }
+  }
+}
+
+
+// decode source row a_row shades into a_dst, rows outside of symbol place are background,
+// source rows are decoded in order
+static void decode_source_row( display_char_scaled_s * a_data, int a_row, uint8_t * a_dst ) {
+  if ( a_row < 0 || a_row >= a_data->m_src.m_font->m_row_height ) {
+    memset( a_dst, 0, a_data->m_src.m_cols_count );
+    return;
+  }
+  while ( a_data->m_src.m_row < a_row ) {
+    display_char_row_shades( &(a_data->m_src), a_dst );
+  }
+  display_char_row_shades( &(a_data->m_src), a_dst );
+}
+
+
+// prepare one scaled row, source decoder moves when scaled rows pass its row,
+// shades of next source row are kept for it
+bool display_char_row_scaled( display_char_scaled_s * a_data ) {
+  int v_frac = 0;
+  int v_row = a_data->m_smooth
+            ? scaled_source_pos( a_data->m_row, a_data->m_scale, &v_frac )
+            : a_data->m_row / a_data->m_scale;
+  if ( v_row != a_data->m_upper_row ) {
+    if ( a_data->m_smooth && v_row == a_data->m_upper_row + 1 ) {
+      // lower source row becomes upper one
+      a_data->m_upper ^= 1;
+    } else {
+      decode_source_row( a_data, v_row, a_data->m_shades[a_data->m_upper] );
+    }
+    if ( a_data->m_smooth ) {
+      decode_source_row( a_data, v_row + 1, a_data->m_shades[a_data->m_upper ^ 1] );
+    }
+    a_data->m_upper_row = v_row;
+  }
+  if ( !a_data->m_smooth ) {
+    expand_row( a_data, a_data->m_shades[a_data->m_upper] );
+  } else {
+    interpolate_row( a_data, a_data->m_shades[a_data->m_upper], a_data->m_shades[a_data->m_upper ^ 1], v_frac );
+  }
+  //
+  return ++a_data->m_row >= a_data->m_rows_count;
+}
+
+
+// prepare to display one scaled text line, init a_data structure and decoders for each symbol
+void display_line_init_scaled( display_line_scaled_s * a_data, const char * a_str, const packed_font_desc_s * a_font, uint16_t * a_dst_row, int a_width, display_char_scaled_s * a_chars, int a_chars_max, const display_palette_s * a_palette, int a_scale, bool a_smooth ) {
+  a_data->m_font = a_font;
+  a_data->m_chars = a_chars;
+  a_data->m_chars_count = 0;
+  a_data->m_pixbuf = a_dst_row;
+  a_data->m_width = a_width;
+  a_data->m_text_width = 0;
+  a_data->m_row = 0;
+  a_data->m_scale = clamp_scale( a_scale );
+  a_data->m_next = 0;
+  a_data->m_bgcolor = a_palette->m_colors[0];
+  // place symbols of line (up to LF) while they fit into row
+  line_codes_s v_codes;
+  line_codes_init( &v_codes, a_str );
+  uint32_t v_code;
+  while ( line_codes_next( &v_codes, &v_code ) ) {
+    if ( a_data->m_chars_count >= a_chars_max ) {
+      break;
+    }
+    display_char_scaled_s * v_char = &(a_chars[a_data->m_chars_count]);
+    display_char_init_scaled( v_char, v_code, a_font, a_dst_row + a_data->m_text_width, a_palette, a_scale, a_smooth );
+    if ( (a_data->m_text_width + v_char->m_cols_count) > a_width ) {
+      break;
+    }
+    a_data->m_text_width += v_char->m_cols_count;
+    ++a_data->m_chars_count;
+  }
+  a_data->m_next = line_codes_rest( &v_codes );
+}
+
+
+// prepare one full-width scaled row pixels buffer, returns true, if it was last row
+bool display_line_row_scaled( display_line_scaled_s * a_data ) {
+  for ( int i = 0; i < a_data->m_chars_count; ++i ) {
+    display_char_row_scaled( &(a_data->m_chars[i]) );
+  }
+  // background color up to row width
+  uint16_t * v_dst = a_data->m_pixbuf + a_data->m_text_width;
+  for ( int i = a_data->m_text_width; i < a_data->m_width; ++i ) {
+    *v_dst++ = a_data->m_bgcolor;
+  }
+  //
+  return ++a_data->m_row >= a_data->m_font->m_row_height * a_data->m_scale;
+}
+
+
+// get rectangle size for text scaled a_scale times, integer scaling keeps proportions exactly
+void get_text_extent_scaled( const packed_font_desc_s * a_font, const char * a_str, int a_scale, int * a_width, int * a_height ) {
+  a_scale = clamp_scale( a_scale );
+  get_text_extent( a_font, a_str, a_width, a_height );
+  *a_width *= a_scale;
+  *a_height *= a_scale;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,67 @@
+#ifndef __FONT_BMP_SCALE_H__
+#define __FONT_BMP_SCALE_H__
+
+#include "font_bmp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// integer upscaling at decode time, one stored font size serves 2x, 3x and 4x sizes
+#define SCALE_MIN 1
+#define SCALE_MAX 4
+// source symbol row of shades, x_offset + width may exceed x_advance up to 255 pixels
+#define SCALE_ROW_BUFFER_SIZE 512
+
+
+// scaled symbol, each source row is decoded once into shades when scaled rows reach it (no symbol bitmap
+// buffer, two source rows are kept), structure must not be copied while symbol is displayed
+// (m_src.m_symbol may point to m_src.m_symbol_buf)
+typedef struct {
+  display_char_s m_src;                   // source symbol decoder, at first source row not decoded yet
+  uint8_t m_shades[2][SCALE_ROW_BUFFER_SIZE]; // shades of upper source row of current row and of next one
+  int m_upper;                            // m_shades index of upper source row
+  int m_upper_row;                        // upper source row, -1 above first row (smooth scaling)
+  uint16_t * m_pixbuf;                    // dst pixels row, m_cols_count pixels
+  int m_cols_count;                       // scaled width of symbol place, x_advance * m_scale
+  int m_row;                              // current scaled row to display
+  int m_rows_count;                       // scaled row height, row_height * m_scale
+  int m_scale;                            // SCALE_MIN..SCALE_MAX
+  bool m_smooth;                          // shades interpolated between neighboring source pixels, else replicated
+} display_char_scaled_s;
+
+
+// scaled text line structure
+typedef struct {
+  const packed_font_desc_s * m_font;      // font desc ptr
+  display_char_scaled_s * m_chars;        // symbols within line, one decoder per symbol
+  int m_chars_count;                      // used decoders
+  uint16_t * m_pixbuf;                    // dst pixels row
+  int m_width;                            // dst row width in pixels
+  int m_text_width;                       // scaled width in pixels of placed symbols
+  int m_row;                              // current scaled row to display
+  int m_scale;                            // SCALE_MIN..SCALE_MAX
+  uint16_t m_bgcolor;                     // packed background color for tail
+  const char * m_next;                    // next text line (after LF), or 0 at end of string
+} display_line_scaled_s;
+
+
+// prepare to display symbol scaled a_scale times (clamped to SCALE_MIN..SCALE_MAX) using prepared palette,
+// a_smooth - bilinear interpolation of shades, else each source pixel becomes a_scale x a_scale pixels
+void display_char_init_scaled( display_char_scaled_s * a_data, uint32_t a_code, const packed_font_desc_s * a_font, uint16_t * a_dst_row, const display_palette_s * a_palette, int a_scale, bool a_smooth );
+// prepare one scaled row pixels buffer, returns true, if it was last row
+bool display_char_row_scaled( display_char_scaled_s * a_data );
+// prepare to display one scaled text line (up to LF), symbols not fitting into a_width are dropped,
+// a_chars - storage for a_chars_max symbol decoders
+void display_line_init_scaled( display_line_scaled_s * a_data, const char * a_str, const packed_font_desc_s * a_font, uint16_t * a_dst_row, int a_width, display_char_scaled_s * a_chars, int a_chars_max, const display_palette_s * a_palette, int a_scale, bool a_smooth );
+// prepare one full-width scaled row pixels buffer for all symbols of line, returns true, if it was last row
+bool display_line_row_scaled( display_line_scaled_s * a_data );
+// get rectangle size for text scaled a_scale times
+void get_text_extent_scaled( const packed_font_desc_s * a_font, const char * a_str, int a_scale, int * a_width, int * a_height );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FONT_BMP_SCALE_H__
@@ -0,0 +1,320 @@
+#include "font_bmp_simd.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SIMD_X86
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef bool (*char_row_t)( display_char_s * a_data );
+
+
+#ifdef SIMD_X86
+
+// fill pixels with color
+typedef void (*fill_t)( uint16_t * a_dst, uint16_t a_color, int a_count );
+
+
+__attribute__((target("ssse3")))
+static void fill_sse( uint16_t * a_dst, uint16_t a_color, int a_count ) {
+  __m128i v_c = _mm_set1_epi16( (short)a_color );
+  for ( ; a_count >= 8; a_count -= 8, a_dst += 8 ) {
+    _mm_storeu_si128( (__m128i *)a_dst, v_c );
+  }
+  for ( ; a_count > 0; --a_count ) {
+    *a_dst++ = a_color;
+  }
+}
+
+
+__attribute__((target("avx2")))
+static void fill_avx2( uint16_t * a_dst, uint16_t a_color, int a_count ) {
+  __m256i v_c = _mm256_set1_epi16( (short)a_color );
+  for ( ; a_count >= 16; a_count -= 16, a_dst += 16 ) {
+    _mm256_storeu_si256( (__m256i *)a_dst, v_c );
+  }
+  if ( a_count >= 8 ) {
+    _mm_storeu_si128( (__m128i *)a_dst, _mm256_castsi256_si128( v_c ) );
+    a_count -= 8;
+    a_dst += 8;
+  }
+  for ( ; a_count > 0; --a_count ) {
+    *a_dst++ = a_color;
+  }
+}
+
+
+// get next nibble from symbol packed data
+static uint8_t next_nibble( display_char_s * a_data ) {
+  uint8_t v_packed_color;
+  if ( a_data->m_curr_nibble ) {
+    // low nibble
+    v_packed_color = a_data->m_curr_byte & 0x0F;
+    a_data->m_curr_nibble = false;
+    a_data->m_curr_byte = *a_data->m_bmp_ptr++;
+  } else {
+    // high nibble
+    v_packed_color = (a_data->m_curr_byte >> 4) & 0x0F;
+    a_data->m_curr_nibble = true;
+  }
+  return v_packed_color;
+}
+
+
+// skip a_count nibbles of packed data
+static void skip_nibbles( display_char_s * a_data, int a_count ) {
+  const packed_font_desc_s * v_font = a_data->m_font;
+  uint32_t v_pos = (uint32_t)(a_data->m_bmp_ptr - 1 - v_font->m_bmp) * 2 + (a_data->m_curr_nibble ? 1 : 0) + a_count;
+  a_data->m_bmp_ptr = v_font->m_bmp + (v_pos >> 1);
+  a_data->m_curr_nibble = (0 != (v_pos & 1));
+  a_data->m_curr_byte = (v_pos >> 1) < v_font->m_bmp_size ? *a_data->m_bmp_ptr : 0;
+  ++a_data->m_bmp_ptr;
+}
+
+
+// decode up to 16 nibbles at once from current position of packed data,
+// returns count of consumed nibbles, 0 if no one run fits into row;
+// nibble is run of 1 (color) or 1..8 (repeat) pixels, runs positions are prefix sums of lengths,
+// repeats take color of left neighbour, propagated by log-step scan
+__attribute__((target("ssse3"), always_inline))
+static inline int decode_block( display_char_s * a_data, uint16_t * a_dst, int * a_col, int a_last_col, int a_x_advance ) {
+  const uint8_t * v_src = a_data->m_bmp_ptr - 1;
+  if ( v_src + 8 > a_data->m_font->m_bmp + a_data->m_font->m_bmp_size ) {
+    return 0;
+  }
+  const uint16_t * v_colors = a_data->m_colors;
+  int v_odd = a_data->m_curr_nibble ? 1 : 0;
+  int v_valid = 16 - v_odd;
+  int v_rem_bmp = a_last_col - *a_col;
+  if ( v_rem_bmp > 255 ) {
+    v_rem_bmp = 255;
+  }
+  int v_rem_adv = a_x_advance - *a_col;
+  if ( v_rem_adv < 0 ) {
+    // symbol bitmap wider than x_advance
+    v_rem_adv = 0;
+  }
+  const __m128i v_0f = _mm_set1_epi8( 0x0F );
+  const __m128i v_08 = _mm_set1_epi8( 0x08 );
+  const __m128i v_ff = _mm_set1_epi8( (char)0xFF );
+  uint8_t v_runs_colors[16];
+  // nibbles in packed data order, high nibble first
+  __m128i v_bytes = _mm_loadl_epi64( (const __m128i *)v_src );
+  __m128i v_nib = _mm_unpacklo_epi8( _mm_and_si128( _mm_srli_epi16( v_bytes, 4 ), v_0f ), _mm_and_si128( v_bytes, v_0f ) );
+  if ( v_odd ) {
+    v_nib = _mm_srli_si128( v_nib, 1 );
+  }
+  __m128i v_rep = _mm_cmpeq_epi8( _mm_and_si128( v_nib, v_08 ), v_08 );
+  if ( 0 == v_odd && v_rem_bmp >= 16 && 0 == _mm_movemask_epi8( v_rep ) ) {
+    // 16 colors, both bytes of pixels by table lookup
+    __m128i v_tbl_lo = _mm_setr_epi8( (char)v_colors[0], (char)v_colors[1], (char)v_colors[2], (char)v_colors[3]
+                                    , (char)v_colors[4], (char)v_colors[5], (char)v_colors[6], (char)v_colors[7]
+                                    , 0, 0, 0, 0, 0, 0, 0, 0 );
+    __m128i v_tbl_hi = _mm_setr_epi8( (char)(v_colors[0] >> 8), (char)(v_colors[1] >> 8), (char)(v_colors[2] >> 8), (char)(v_colors[3] >> 8)
+                                    , (char)(v_colors[4] >> 8), (char)(v_colors[5] >> 8), (char)(v_colors[6] >> 8), (char)(v_colors[7] >> 8)
+                                    , 0, 0, 0, 0, 0, 0, 0, 0 );
+    __m128i v_lo = _mm_shuffle_epi8( v_tbl_lo, v_nib );
+    __m128i v_hi = _mm_shuffle_epi8( v_tbl_hi, v_nib );
+    _mm_storeu_si128( (__m128i *)(a_dst + *a_col), _mm_unpacklo_epi8( v_lo, v_hi ) );
+    _mm_storeu_si128( (__m128i *)(a_dst + *a_col + 8), _mm_unpackhi_epi8( v_lo, v_hi ) );
+    _mm_storeu_si128( (__m128i *)v_runs_colors, v_nib );
+    a_data->m_curr_color = v_runs_colors[15];
+    *a_col += 16;
+    return 16;
+  }
+  // runs lengths, ends and starts
+  __m128i v_len = _mm_add_epi8( _mm_and_si128( _mm_and_si128( v_nib, _mm_set1_epi8( 0x07 ) ), v_rep ), _mm_set1_epi8( 0x01 ) );
+  __m128i v_end = v_len;
+  v_end = _mm_add_epi8( v_end, _mm_slli_si128( v_end, 1 ) );
+  v_end = _mm_add_epi8( v_end, _mm_slli_si128( v_end, 2 ) );
+  v_end = _mm_add_epi8( v_end, _mm_slli_si128( v_end, 4 ) );
+  v_end = _mm_add_epi8( v_end, _mm_slli_si128( v_end, 8 ) );
+  __m128i v_start = _mm_sub_epi8( v_end, v_len );
+  // runs colors, 0xFF for repeats replaced by left neighbour, current color from the left of block
+  __m128i v_carry = _mm_set1_epi8( (char)a_data->m_curr_color );
+  __m128i v_c = _mm_or_si128( _mm_andnot_si128( v_rep, v_nib ), v_rep );
+  __m128i v_m;
+  v_m = _mm_cmpeq_epi8( v_c, v_ff );
+  v_c = _mm_or_si128( _mm_and_si128( v_m, _mm_alignr_epi8( v_c, v_carry, 15 ) ), _mm_andnot_si128( v_m, v_c ) );
+  v_m = _mm_cmpeq_epi8( v_c, v_ff );
+  v_c = _mm_or_si128( _mm_and_si128( v_m, _mm_alignr_epi8( v_c, v_carry, 14 ) ), _mm_andnot_si128( v_m, v_c ) );
+  v_m = _mm_cmpeq_epi8( v_c, v_ff );
+  v_c = _mm_or_si128( _mm_and_si128( v_m, _mm_alignr_epi8( v_c, v_carry, 12 ) ), _mm_andnot_si128( v_m, v_c ) );
+  v_m = _mm_cmpeq_epi8( v_c, v_ff );
+  v_c = _mm_or_si128( _mm_and_si128( v_m, _mm_alignr_epi8( v_c, v_carry, 8 ) ), _mm_andnot_si128( v_m, v_c ) );
+  // runs ending within bitmap row, with room for 8 pixels store up to x_advance
+  __m128i v_store_end = _mm_add_epi8( v_start, _mm_set1_epi8( 8 ) );
+  __m128i v_ok = _mm_and_si128( _mm_cmpeq_epi8( _mm_min_epu8( v_end, _mm_set1_epi8( (char)v_rem_bmp ) ), v_end )
+                              , _mm_cmpeq_epi8( _mm_min_epu8( v_store_end, _mm_set1_epi8( (char)v_rem_adv ) ), v_store_end ) );
+  int v_count = __builtin_ctz( ~(_mm_movemask_epi8( v_ok ) & ((1 << v_valid) - 1)) );
+  if ( 0 == v_count ) {
+    return 0;
+  }
+  uint8_t v_starts[16];
+  uint8_t v_ends[16];
+  _mm_storeu_si128( (__m128i *)v_starts, v_start );
+  _mm_storeu_si128( (__m128i *)v_ends, v_end );
+  _mm_storeu_si128( (__m128i *)v_runs_colors, v_c );
+  // each run written by 8 pixels store, next run overwrites the rest
+  uint16_t * v_dst = a_dst + *a_col;
+  for ( int i = 0; i < v_count; ++i ) {
+    _mm_storeu_si128( (__m128i *)(v_dst + v_starts[i]), _mm_set1_epi16( (short)v_colors[v_runs_colors[i]] ) );
+  }
+  a_data->m_curr_color = v_runs_colors[v_count - 1];
+  *a_col += v_ends[v_count - 1];
+  return v_count;
+}
+
+
+__attribute__((target("ssse3"), always_inline))
+static inline bool char_row_simd( display_char_s * a_data, fill_t a_fill ) {
+  const packed_symbol_desc_s * v_symbol = a_data->m_symbol;
+  uint16_t * v_dst = a_data->m_pixbuf;
+  const uint16_t * v_colors = a_data->m_colors;
+  int v_x_advance = v_symbol->m_x_advance;
+  if ( a_data->m_row < v_symbol->m_y_offset || a_data->m_row >= a_data->m_last_row ) {
+    // top or bottom space
+    a_fill( v_dst, v_colors[0], v_x_advance );
+  } else {
+    int v_col = v_symbol->m_x_offset;
+    int v_last_col = a_data->m_last_col;
+    bool v_blocks = (0 != a_data->m_font->m_bmp_size);
+    // x offset
+    a_fill( v_dst, v_colors[0], v_col );
+    while ( v_col < v_last_col ) {
+      if ( 0 == a_data->m_counter ) {
+        if ( v_blocks ) {
+          int v_nibbles = decode_block( a_data, v_dst, &v_col, v_last_col, v_x_advance );
+          if ( v_nibbles > 0 ) {
+            skip_nibbles( a_data, v_nibbles );
+            continue;
+          }
+          // near end of row, rest one by one
+          v_blocks = false;
+        }
+        uint8_t v_packed_color = next_nibble( a_data );
+        if ( 0 == (v_packed_color & 0x08) ) {
+          a_data->m_curr_color = v_packed_color;
+          v_dst[v_col++] = v_colors[v_packed_color];
+          continue;
+        }
+        a_data->m_counter = (v_packed_color & 0x07) + 1;
+      }
+      // repeated color
+      int v_count = a_data->m_counter < (v_last_col - v_col) ? a_data->m_counter : (v_last_col - v_col);
+      a_fill( v_dst + v_col, v_colors[a_data->m_curr_color], v_count );
+      a_data->m_counter -= v_count;
+      v_col += v_count;
+    }
+    // background up to x_advance
+    if ( v_col < v_x_advance ) {
+      a_fill( v_dst + v_col, v_colors[0], v_x_advance - v_col );
+    }
+  }
+  return ++a_data->m_row >= a_data->m_font->m_row_height;
+}
+
+
+__attribute__((target("ssse3")))
+static bool char_row_ssse3( display_char_s * a_data ) {
+  return char_row_simd( a_data, fill_sse );
+}
+
+
+__attribute__((target("avx2")))
+static bool char_row_avx2( display_char_s * a_data ) {
+  return char_row_simd( a_data, fill_avx2 );
+}
+
+#endif // SIMD_X86
+
+
+// implementation of display_char_row_fast, display_char_row until selected
+static char_row_t g_char_row = display_char_row;
+static int g_level = SIMD_LEVEL_SCALAR;
+
+
+// best level supported by processor
+static int get_supported_level( void ) {
+#ifdef SIMD_X86
+  __builtin_cpu_init();
+  if ( __builtin_cpu_supports( "avx2" ) ) {
+    return SIMD_LEVEL_AVX2;
+  }
+  if ( __builtin_cpu_supports( "ssse3" ) ) {
+    return SIMD_LEVEL_SSSE3;
+  }
+#endif
+  return SIMD_LEVEL_SCALAR;
+}
+
+
+int font_bmp_simd_set_level( int a_level ) {
+  int v_supported = get_supported_level();
+  if ( a_level < SIMD_LEVEL_SCALAR || a_level > v_supported ) {
+    a_level = v_supported;
+  }
+  char_row_t v_char_row = display_char_row;
+#ifdef SIMD_X86
+  if ( SIMD_LEVEL_AVX2 == a_level ) {
+    v_char_row = char_row_avx2;
+  } else if ( SIMD_LEVEL_SSSE3 == a_level ) {
+    v_char_row = char_row_ssse3;
+  }
+#endif
+  g_char_row = v_char_row;
+  g_level = a_level;
+  return a_level;
+}
+
+
+int font_bmp_simd_get_level( void ) {
+  return g_level;
+}
+
+
+#ifdef SIMD_X86
+// best implementation is selected once at program start, before any rendering threads
+__attribute__((constructor))
+static void char_row_select( void ) {
+  font_bmp_simd_set_level( -1 );
+}
+#endif
+
+
+bool display_char_row_fast( display_char_s * a_data ) {
+  // huffman coded data has no fixed size codes for blocks decoding
+  if ( a_data->m_font->m_huffman ) {
+    return display_char_row( a_data );
+  }
+  return g_char_row( a_data );
+}
+
+
+bool display_line_row_fast( display_line_s * a_data ) {
+  // huffman coded data has no fixed size codes for blocks decoding
+  char_row_t v_char_row = a_data->m_font->m_huffman ? display_char_row : g_char_row;
+  for ( int i = 0; i < a_data->m_chars_count; ++i ) {
+    display_char_s * v_char = &(a_data->m_chars[i]);
+    if ( (v_char->m_pixbuf - a_data->m_pixbuf) + v_char->m_last_col <= a_data->m_width ) {
+      v_char_row( v_char );
+    } else {
+      // symbol pixels beyond x_advance would get out of row
+      display_char_row_clip( v_char, 0, v_char->m_cols_count );
+    }
+  }
+  // background color up to row width
+  uint16_t * v_dst = a_data->m_pixbuf + a_data->m_text_width;
+  for ( int i = a_data->m_text_width; i < a_data->m_width; ++i ) {
+    *v_dst++ = a_data->m_bgcolor;
+  }
+  return ++a_data->m_row >= a_data->m_font->m_row_height;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
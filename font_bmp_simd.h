@@ -0,0 +1,35 @@
+#ifndef __FONT_BMP_SIMD_H__
+#define __FONT_BMP_SIMD_H__
+
+#include "font_bmp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// same as display_char_row, for host side rendering of large text:
+// 16 nibbles decoded at once, repeats expanded by prefix sums, pixels written by wide stores,
+// SSSE3/AVX2 selected at program start on x86, display_char_row used on other targets,
+// packed data is read by 8 bytes, so font must have m_bmp_size, else symbol runs decoded one by one,
+// huffman coded fonts are displayed by display_char_row
+bool display_char_row_fast( display_char_s * a_data );
+// same as display_line_row, symbols rows prepared by display_char_row_fast
+bool display_line_row_fast( display_line_s * a_data );
+
+// implementations of display_char_row_fast, best supported one is selected at program start
+#define SIMD_LEVEL_SCALAR 0               // display_char_row
+#define SIMD_LEVEL_SSSE3  1
+#define SIMD_LEVEL_AVX2   2
+
+// select implementation (for tests), level above supported one or negative selects best supported,
+// returns selected level; not thread-safe, call while no rows are rendered
+int font_bmp_simd_set_level( int a_level );
+// selected implementation
+int font_bmp_simd_get_level( void );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FONT_BMP_SIMD_H__
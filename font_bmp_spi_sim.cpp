@@ -0,0 +1,142 @@
+//
+#include <chrono>
+
+#include <stddef.h>
+
+#include "font_bmp_spi_sim.h"
+
+
+typedef std::chrono::steady_clock sim_clock_t;
+
+
+struct spi_sim_s {
+  stream_sink_s m_sink;
+  double m_bits_per_second;
+  uint16_t * m_panel;                     // panel memory, may be 0
+  int m_panel_width;
+  int m_panel_height;
+  // window and position of next pixel within it
+  int m_x;
+  int m_y;
+  int m_width;
+  int64_t m_pos;
+  // transfer on bus
+  const uint16_t * m_pixels;              // 0 - bus is idle
+  int m_count;
+  double m_bus_free;                      // simulated time of transfer end
+  // simulated time is clock time since m_origin plus waits
+  sim_clock_t::time_point m_origin;
+  spi_sim_stats_s m_stats;
+  spi_sim_s( double a_bits_per_second, uint16_t * a_panel, int a_width, int a_height )
+    : m_bits_per_second(a_bits_per_second)
+    , m_panel(a_panel)
+    , m_panel_width(a_width)
+    , m_panel_height(a_height)
+    , m_x(0)
+    , m_y(0)
+    , m_width(0)
+    , m_pos(0)
+    , m_pixels(0)
+    , m_count(0)
+    , m_bus_free(0)
+    , m_origin(sim_clock_t::now())
+    , m_stats()
+    {}
+};
+
+
+// current simulated time in seconds
+static double sim_now( const spi_sim_s * a_sim ) {
+  return std::chrono::duration<double>( sim_clock_t::now() - a_sim->m_origin ).count() + a_sim->m_stats.m_wait_seconds;
+}
+
+
+// end transfer on bus: caller waits for its end, pixels get into panel window
+static void wait_idle( spi_sim_s * a_sim ) {
+  if ( !a_sim->m_pixels ) {
+    return;
+  }
+  double v_now = sim_now( a_sim );
+  if ( v_now < a_sim->m_bus_free ) {
+    a_sim->m_stats.m_wait_seconds += a_sim->m_bus_free - v_now;
+  }
+  // copying isn't caller's time, DMA does it
+  sim_clock_t::time_point v_start = sim_clock_t::now();
+  for ( int i = 0; i < a_sim->m_count && a_sim->m_width > 0; ++i, ++a_sim->m_pos ) {
+    int v_x = a_sim->m_x + (int)(a_sim->m_pos % a_sim->m_width);
+    int v_y = a_sim->m_y + (int)(a_sim->m_pos / a_sim->m_width);
+    if ( a_sim->m_panel && v_x >= 0 && v_x < a_sim->m_panel_width && v_y >= 0 && v_y < a_sim->m_panel_height ) {
+      a_sim->m_panel[(ptrdiff_t)v_y * a_sim->m_panel_width + v_x] = a_sim->m_pixels[i];
+    }
+  }
+  a_sim->m_origin += sim_clock_t::now() - v_start;
+  a_sim->m_pixels = 0;
+}
+
+
+static void sink_begin( void * a_ctx, int a_x, int a_y, int a_width, int ) {
+  spi_sim_s * v_sim = (spi_sim_s *)a_ctx;
+  wait_idle( v_sim );
+  v_sim->m_x = a_x;
+  v_sim->m_y = a_y;
+  v_sim->m_width = a_width;
+  v_sim->m_pos = 0;
+}
+
+
+static void sink_push( void * a_ctx, const uint16_t * a_pixels, int a_count ) {
+  spi_sim_s * v_sim = (spi_sim_s *)a_ctx;
+  if ( a_count <= 0 ) {
+    return;
+  }
+  // one transfer at a time
+  wait_idle( v_sim );
+  double v_seconds = a_count * 16.0 / v_sim->m_bits_per_second;
+  v_sim->m_pixels = a_pixels;
+  v_sim->m_count = a_count;
+  v_sim->m_bus_free = sim_now( v_sim ) + v_seconds;
+  ++v_sim->m_stats.m_transfers;
+  v_sim->m_stats.m_pixels += a_count;
+  v_sim->m_stats.m_bus_seconds += v_seconds;
+  if ( !v_sim->m_sink.m_wait ) {
+    wait_idle( v_sim );
+  }
+}
+
+
+static void sink_wait( void * a_ctx ) {
+  wait_idle( (spi_sim_s *)a_ctx );
+}
+
+
+spi_sim_s * spi_sim_create( double a_bits_per_second, uint16_t * a_panel, int a_width, int a_height, bool a_async ) {
+  spi_sim_s * v_result = new spi_sim_s( a_bits_per_second > 0 ? a_bits_per_second : 1, a_panel, a_width, a_height );
+  v_result->m_sink.m_ctx = v_result;
+  v_result->m_sink.m_begin = sink_begin;
+  v_result->m_sink.m_push = sink_push;
+  v_result->m_sink.m_wait = a_async ? sink_wait : 0;
+  v_result->m_sink.m_end = sink_wait;
+  return v_result;
+}
+
+
+void spi_sim_destroy( spi_sim_s * a_sim ) {
+  delete a_sim;
+}
+
+
+const stream_sink_s * spi_sim_sink( spi_sim_s * a_sim ) {
+  return &(a_sim->m_sink);
+}
+
+
+void spi_sim_get_stats( spi_sim_s * a_sim, spi_sim_stats_s * a_stats, bool a_reset ) {
+  wait_idle( a_sim );
+  *a_stats = a_sim->m_stats;
+  a_stats->m_seconds = sim_now( a_sim );
+  if ( a_reset ) {
+    a_sim->m_stats = spi_sim_stats_s();
+    a_sim->m_bus_free = 0;
+    a_sim->m_origin = sim_clock_t::now();
+  }
+}
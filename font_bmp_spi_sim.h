@@ -0,0 +1,44 @@
+#ifndef __FONT_BMP_SPI_SIM_H__
+#define __FONT_BMP_SPI_SIM_H__
+
+#include "font_bmp_stream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// simulated panel on SPI bus with DMA for host side tests of streaming: pushed pixels take as much time
+// as bus of given bit rate needs for them (16 bits per pixel) while caller goes on; time is simulated,
+// caller's own time is measured by clock and time it would be blocked by bus is added to it instead of
+// sleeping, so results don't depend on sleep precision and cores count; one caller thread
+typedef struct spi_sim_s spi_sim_s;
+
+
+// transfers statistics
+typedef struct {
+  uint64_t m_transfers;                   // pushed pixels blocks
+  uint64_t m_pixels;                      // pushed pixels
+  double m_bus_seconds;                   // bus busy time
+  double m_wait_seconds;                  // time caller would be blocked by bus
+  double m_seconds;                       // simulated time, caller's time with waits
+} spi_sim_stats_s;
+
+
+// create simulated panel, a_bits_per_second - bus bit rate, a_panel - a_width x a_height pixels of
+// panel memory (0 - pixels are dropped), pixels out of panel are dropped, pixels are written into it
+// when transfer ends (buffer changed before stream_wait_t gives wrong pixels on panel);
+// a_async - m_push starts transfer and returns (DMA), else m_push returns when pixels are sent
+spi_sim_s * spi_sim_create( double a_bits_per_second, uint16_t * a_panel, int a_width, int a_height, bool a_async );
+// destroy panel
+void spi_sim_destroy( spi_sim_s * a_sim );
+// sink of panel for stream_init, valid until panel is destroyed
+const stream_sink_s * spi_sim_sink( spi_sim_s * a_sim );
+// get statistics collected since creation or last reset, pushed pixels are waited for first
+void spi_sim_get_stats( spi_sim_s * a_sim, spi_sim_stats_s * a_stats, bool a_reset );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FONT_BMP_SPI_SIM_H__
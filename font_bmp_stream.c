@@ -0,0 +1,116 @@
+#include "font_bmp_stream.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// init stream
+void stream_init( stream_s * a_stream, const stream_sink_s * a_sink, uint16_t * a_buffer0, uint16_t * a_buffer1, int a_buffer_size ) {
+  a_stream->m_sink = a_sink;
+  a_stream->m_buffers[0] = a_buffer0;
+  a_stream->m_buffers[1] = a_buffer1;
+  a_stream->m_buffer_size = a_buffer_size;
+  a_stream->m_buffer = 0;
+  a_stream->m_width = 0;
+  a_stream->m_band_rows = 0;
+  a_stream->m_rows = 0;
+  a_stream->m_rows_left = 0;
+  a_stream->m_pending = false;
+}
+
+
+// wait for band being sent
+static void stream_wait( stream_s * a_stream ) {
+  if ( a_stream->m_pending ) {
+    if ( a_stream->m_sink->m_wait ) {
+      a_stream->m_sink->m_wait( a_stream->m_sink->m_ctx );
+    }
+    a_stream->m_pending = false;
+  }
+}
+
+
+// push filled rows of current band, next band goes into other buffer
+static void stream_flush( stream_s * a_stream ) {
+  if ( 0 == a_stream->m_rows ) {
+    return;
+  }
+  // sink sends one band at a time, other buffer was sent before it
+  stream_wait( a_stream );
+  a_stream->m_sink->m_push( a_stream->m_sink->m_ctx, a_stream->m_buffers[a_stream->m_buffer], a_stream->m_rows * a_stream->m_width );
+  a_stream->m_pending = true;
+  a_stream->m_rows = 0;
+  if ( a_stream->m_buffers[1] ) {
+    a_stream->m_buffer ^= 1;
+  } else {
+    // the only buffer is filled again after it is sent
+    stream_wait( a_stream );
+  }
+}
+
+
+// start window
+bool stream_begin( stream_s * a_stream, int a_x, int a_y, int a_width, int a_height ) {
+  if ( a_width <= 0 || a_width > a_stream->m_buffer_size ) {
+    return false;
+  }
+  // bus is busy by previous window yet
+  stream_wait( a_stream );
+  a_stream->m_width = a_width;
+  a_stream->m_band_rows = a_stream->m_buffer_size / a_width;
+  a_stream->m_rows = 0;
+  a_stream->m_rows_left = a_height > 0 ? a_height : 0;
+  a_stream->m_sink->m_begin( a_stream->m_sink->m_ctx, a_x, a_y, a_width, a_height );
+  return true;
+}
+
+
+// next row to fill, band is pushed when it is full
+uint16_t * stream_row( stream_s * a_stream ) {
+  if ( a_stream->m_rows_left <= 0 ) {
+    return 0;
+  }
+  if ( a_stream->m_rows >= a_stream->m_band_rows ) {
+    stream_flush( a_stream );
+  }
+  --a_stream->m_rows_left;
+  return a_stream->m_buffers[a_stream->m_buffer] + a_stream->m_rows++ * a_stream->m_width;
+}
+
+
+// push last band and end window
+void stream_end( stream_s * a_stream ) {
+  stream_flush( a_stream );
+  stream_wait( a_stream );
+  a_stream->m_rows_left = 0;
+  if ( a_stream->m_sink->m_end ) {
+    a_stream->m_sink->m_end( a_stream->m_sink->m_ctx );
+  }
+}
+
+
+// display line rows into stream rows, symbols decoders are moved with row
+bool stream_line( stream_s * a_stream, display_line_s * a_line ) {
+  // line row is written into stream row as whole
+  if ( a_line->m_width != a_stream->m_width ) {
+    return false;
+  }
+  while ( a_line->m_row < a_line->m_font->m_row_height ) {
+    uint16_t * v_dst = stream_row( a_stream );
+    if ( !v_dst ) {
+      break;
+    }
+    for ( int i = 0; i < a_line->m_chars_count; ++i ) {
+      display_char_s * v_char = &(a_line->m_chars[i]);
+      v_char->m_pixbuf = v_dst + (v_char->m_pixbuf - a_line->m_pixbuf);
+    }
+    a_line->m_pixbuf = v_dst;
+    display_line_row( a_line );
+  }
+  return true;
+}
+
+
+#ifdef __cplusplus
+}
+#endif
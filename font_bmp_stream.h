@@ -0,0 +1,68 @@
+#ifndef __FONT_BMP_STREAM_H__
+#define __FONT_BMP_STREAM_H__
+
+#include "font_bmp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// set panel window a_x, a_y, a_width x a_height, pixels follow row by row
+typedef void (*stream_begin_t)( void * a_ctx, int a_x, int a_y, int a_width, int a_height );
+// start sending a_count byte swapped R5G6B5 pixels, may return before they are sent (DMA),
+// pixels are kept unchanged until next stream_wait_t call returns
+typedef void (*stream_push_t)( void * a_ctx, const uint16_t * a_pixels, int a_count );
+// wait until pushed pixels are sent
+typedef void (*stream_wait_t)( void * a_ctx );
+// window is complete
+typedef void (*stream_end_t)( void * a_ctx );
+
+
+// pixels sink (panel bus driver), one transfer at a time
+typedef struct {
+  void * m_ctx;                           // sink context, first argument of callbacks
+  stream_begin_t m_begin;
+  stream_push_t m_push;
+  stream_wait_t m_wait;                   // 0 - m_push returns when pixels are sent
+  stream_end_t m_end;                     // may be 0
+} stream_sink_s;
+
+
+// streaming of window rows to sink through two bands buffers (ping-pong): rows of next band are
+// rendered into one buffer while sink sends other one, so frame time is close to max(render, transfer)
+typedef struct {
+  const stream_sink_s * m_sink;           // pixels sink
+  uint16_t * m_buffers[2];                // bands buffers, caller memory, [1] is 0 for one buffer
+  int m_buffer_size;                      // pixels in each buffer
+  int m_buffer;                           // buffer being filled, 0 or 1
+  int m_width;                            // window width in pixels
+  int m_band_rows;                        // rows per band, fitting into buffer
+  int m_rows;                             // filled rows of current band
+  int m_rows_left;                        // window rows not given to fill yet
+  bool m_pending;                         // band is being sent
+} stream_s;
+
+
+// init stream, a_buffer0 and a_buffer1 - a_buffer_size pixels each, a_buffer1 may be 0 (no overlap
+// of rendering and transfer, sink is waited for after each band)
+void stream_init( stream_s * a_stream, const stream_sink_s * a_sink, uint16_t * a_buffer0, uint16_t * a_buffer1, int a_buffer_size );
+// start window of a_width x a_height pixels at a_x, a_y, bands are as many rows as fit into buffer,
+// returns false, if one row doesn't fit into buffer
+bool stream_begin( stream_s * a_stream, int a_x, int a_y, int a_width, int a_height );
+// next window row to fill (a_width pixels), filled band is pushed to sink first,
+// returns 0, if all window rows are given already
+uint16_t * stream_row( stream_s * a_stream );
+// push last band, wait until window is sent and end it
+void stream_end( stream_s * a_stream );
+// display rows of text line from its current row (up to row height or window end) into stream rows,
+// line (display_line_init_pal, display_line_init_prepared) must be as wide as window, it is set up with
+// any row buffer (e.g. a_buffer0) and moved to each stream row keeping symbols places,
+// returns false (nothing is written), if line width differs from window width
+bool stream_line( stream_s * a_stream, display_line_s * a_line );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FONT_BMP_STREAM_H__
@@ -0,0 +1,121 @@
+#include "font_bmp_text.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// prepare one text line, symbols are searched once here
+void prepared_text_init( prepared_text_s * a_text, const packed_font_desc_s * a_font, const char * a_str, prepared_glyph_s * a_glyphs, int a_glyphs_max ) {
+  a_text->m_font = a_font;
+  a_text->m_glyphs = a_glyphs;
+  a_text->m_glyphs_count = 0;
+  a_text->m_width = 0;
+  a_text->m_height = a_font->m_row_height;
+  a_text->m_truncated = false;
+  a_text->m_next = 0;
+  // decoder finds symbol desc and index
+  display_char_s v_char;
+  v_char.m_font = a_font;
+  line_codes_s v_codes;
+  line_codes_init( &v_codes, a_str );
+  uint32_t v_code;
+  while ( line_codes_next( &v_codes, &v_code ) ) {
+    if ( a_text->m_glyphs_count >= a_glyphs_max ) {
+      a_text->m_truncated = true;
+      break;
+    }
+    display_char_init2( &v_char, v_code );
+    prepared_glyph_s * v_glyph = &(a_glyphs[a_text->m_glyphs_count++]);
+    v_glyph->m_symbol = *v_char.m_symbol;
+    v_glyph->m_symbol_idx = v_char.m_symbol_idx;
+    v_glyph->m_x = a_text->m_width;
+    a_text->m_width += v_char.m_cols_count;
+  }
+  a_text->m_next = line_codes_rest( &v_codes );
+}
+
+
+// prepare to display prepared text, no utf-8 decoding and symbols search
+void display_line_init_prepared( display_line_s * a_data, const prepared_text_s * a_text, uint16_t * a_dst_row, int a_width, display_char_s * a_chars, int a_chars_max, const display_palette_s * a_palette ) {
+  a_data->m_font = a_text->m_font;
+  a_data->m_chars = a_chars;
+  a_data->m_chars_count = 0;
+  a_data->m_pixbuf = a_dst_row;
+  a_data->m_width = a_width;
+  a_data->m_text_width = 0;
+  a_data->m_row = 0;
+  a_data->m_bgcolor = a_palette->m_colors[0];
+  a_data->m_next = a_text->m_next;
+  for ( int i = 0; i < a_text->m_glyphs_count && i < a_chars_max; ++i ) {
+    const prepared_glyph_s * v_glyph = &(a_text->m_glyphs[i]);
+    if ( (v_glyph->m_x + v_glyph->m_symbol.m_x_advance) > a_width ) {
+      break;
+    }
+    display_char_s * v_char = &(a_chars[i]);
+    v_char->m_font = a_text->m_font;
+    v_char->m_colors = a_palette->m_colors;
+    v_char->m_pixbuf = a_dst_row + v_glyph->m_x;
+    display_char_init_symbol( v_char, &(v_glyph->m_symbol), v_glyph->m_symbol_idx );
+    a_data->m_text_width = v_glyph->m_x + v_glyph->m_symbol.m_x_advance;
+    ++a_data->m_chars_count;
+  }
+}
+
+
+// prepare to display scrolled prepared text, only visible symbols are visited
+void display_line_init_prepared_clip( display_line_clip_s * a_data, const prepared_text_s * a_text, uint16_t * a_dst_row, int a_width, int a_offset, display_char_s * a_chars, int a_chars_max, const display_palette_s * a_palette ) {
+  display_line_s * v_line = &(a_data->m_line);
+  v_line->m_font = a_text->m_font;
+  v_line->m_chars = a_chars;
+  v_line->m_chars_count = 0;
+  v_line->m_pixbuf = a_dst_row;
+  v_line->m_width = a_width;
+  v_line->m_row = 0;
+  v_line->m_bgcolor = a_palette->m_colors[0];
+  v_line->m_next = a_text->m_next;
+  a_data->m_lead = a_offset >= 0 ? 0 : (-a_offset < a_width ? -a_offset : a_width);
+  a_data->m_first_skip = 0;
+  a_data->m_last_count = 0;
+  v_line->m_text_width = a_data->m_lead;
+  // first symbol ending after a_offset, pen positions don't decrease
+  int l = 0;
+  int u = a_text->m_glyphs_count;
+  while ( l < u ) {
+    int v_mid = (l + u) / 2;
+    const prepared_glyph_s * v_glyph = &(a_text->m_glyphs[v_mid]);
+    if ( v_glyph->m_x + v_glyph->m_symbol.m_x_advance <= a_offset ) {
+      l = v_mid + 1;
+    } else {
+      u = v_mid;
+    }
+  }
+  for ( ; l < a_text->m_glyphs_count && v_line->m_chars_count < a_chars_max; ++l ) {
+    const prepared_glyph_s * v_glyph = &(a_text->m_glyphs[l]);
+    int v_pen = v_glyph->m_x - a_offset;
+    int v_advance = v_glyph->m_symbol.m_x_advance;
+    if ( v_pen >= a_width ) {
+      break;
+    }
+    if ( 0 == v_advance ) {
+      continue;
+    }
+    display_char_s * v_char = &(a_chars[v_line->m_chars_count]);
+    int v_skip = v_pen < 0 ? -v_pen : 0;
+    int v_visible_end = v_pen + v_advance < a_width ? v_pen + v_advance : a_width;
+    v_char->m_font = a_text->m_font;
+    v_char->m_colors = a_palette->m_colors;
+    v_char->m_pixbuf = a_dst_row + v_pen + v_skip;
+    display_char_init_symbol( v_char, &(v_glyph->m_symbol), v_glyph->m_symbol_idx );
+    if ( 0 == v_line->m_chars_count ) {
+      a_data->m_first_skip = v_skip;
+    }
+    a_data->m_last_count = v_visible_end - v_pen - v_skip;
+    v_line->m_text_width = v_visible_end;
+    ++v_line->m_chars_count;
+  }
+}
+
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,45 @@
+#ifndef __FONT_BMP_TEXT_H__
+#define __FONT_BMP_TEXT_H__
+
+#include "font_bmp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// symbol of prepared text, everything display_char_init2 finds by code
+typedef struct {
+  packed_symbol_desc_s m_symbol;          // symbol desc (copy, unpacked for compact symbols table), start offset and nibble
+  int m_symbol_idx;                       // symbol index within font
+  int m_x;                                // pen position within line
+} prepared_glyph_s;
+
+
+// prepared text line, built once, displayed many times without utf-8 decoding and symbols search
+typedef struct {
+  const packed_font_desc_s * m_font;      // font desc ptr
+  prepared_glyph_s * m_glyphs;            // symbols of line, caller memory
+  int m_glyphs_count;                     // prepared symbols count
+  int m_width;                            // text width in pixels (sum of x_advance)
+  int m_height;                           // text height in pixels (font row height)
+  bool m_truncated;                       // line has more symbols than room for them
+  const char * m_next;                    // next text line (after LF), or 0 at end of string
+} prepared_text_s;
+
+
+// prepare one text line (up to LF), CR is skipped, a_glyphs - room for a_glyphs_max symbols,
+// symbols after it are dropped (m_truncated is set); a_glyphs must not be moved while text is displayed
+void prepared_text_init( prepared_text_s * a_text, const packed_font_desc_s * a_font, const char * a_str, prepared_glyph_s * a_glyphs, int a_glyphs_max );
+// prepare to display prepared text like display_line_init_pal, symbols not fitting into a_width are dropped,
+// decoders are set up from prepared symbols only; a_chars - storage for a_chars_max symbol decoders
+void display_line_init_prepared( display_line_s * a_data, const prepared_text_s * a_text, uint16_t * a_dst_row, int a_width, display_char_s * a_chars, int a_chars_max, const display_palette_s * a_palette );
+// prepare to display prepared text scrolled by a_offset pixels like display_line_init_clip, first visible
+// symbol is found by binary search of pen positions, display by display_line_row_clip()
+void display_line_init_prepared_clip( display_line_clip_s * a_data, const prepared_text_s * a_text, uint16_t * a_dst_row, int a_width, int a_offset, display_char_s * a_chars, int a_chars_max, const display_palette_s * a_palette );
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __FONT_BMP_TEXT_H__
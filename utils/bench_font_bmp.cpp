@@ -0,0 +1,705 @@
+#include "test32.h"
+#include "font_bmp_text.h"
+#include "font_bmp_spi_sim.h"
+#include "font_bmp_simd.h"
+#include "font_bmp_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+
+// benchmark settings
+struct bench_options_s {
+  int m_runs = 7;                         // measured runs of each benchmark, median reported
+  double m_run_seconds = 0.2;             // minimal duration of one run
+  int m_glyphs = 4000;                    // synthetic font symbols count
+  unsigned m_seed = 1;                    // synthetic font and texts seed
+  const char * m_converter = 0;           // font_2_src path, conversion is timed if set
+  const char * m_work_dir = ".";          // directory for synthetic font files
+  bool m_check = false;                   // check fast rows against display_char_row instead of benchmarks
+};
+
+
+// synthetic font, packed in memory the same way as font_2_src does
+struct synth_font_s {
+  std::vector<uint32_t> m_codes;
+  std::vector<uint8_t> m_shades;          // atlas of shades 0..7
+  std::vector<uint8_t> m_data;
+  std::vector<packed_symbol_desc_s> m_symbols;
+  packed_font_desc_s m_font;
+  std::vector<uint16_t> m_codes16;        // compact symbols table of the same symbols
+  std::vector<uint8_t> m_metrics;
+  packed_compact_symbols_s m_compact;
+  packed_font_desc_s m_compact_font;
+  int m_atlas_width = 2048;
+  int m_atlas_height = 0;
+  int m_max_symbol_width = 0;
+};
+
+
+// keeps results of measured code alive
+static volatile uint32_t g_sink;
+
+
+// nibbles writer of packed symbols data
+struct nibble_writer_s {
+  std::vector<uint8_t> & m_dst;
+  bool m_low = false;
+
+  explicit nibble_writer_s( std::vector<uint8_t> & a_dst ) : m_dst( a_dst ) {}
+
+  void put( uint8_t a_nibble ) {
+    if ( m_low ) {
+      m_dst.back() |= a_nibble;
+    } else {
+      m_dst.push_back( a_nibble << 4 );
+    }
+    m_low = !m_low;
+  }
+};
+
+
+// generate random symbols with runs of shades, codes from ASCII, cyrillic and CJK ranges
+void make_synth_font( synth_font_s & a_dst, int a_count, unsigned a_seed ) {
+  const int v_max_w = 60;
+  const int v_max_h = 48;
+  std::mt19937 v_rnd( a_seed );
+  std::vector<uint32_t> v_pool;
+  for ( uint32_t c = 32; c < 127; ++c ) {
+    v_pool.push_back( c );
+  }
+  for ( uint32_t c = 0x400; c < 0x500; ++c ) {
+    v_pool.push_back( c );
+  }
+  for ( uint32_t c = 0x4E00; c < 0x4E00 + 30000; ++c ) {
+    v_pool.push_back( c );
+  }
+  std::shuffle( v_pool.begin(), v_pool.end(), v_rnd );
+  a_count = std::min( a_count, (int)v_pool.size() );
+  a_dst.m_codes.assign( v_pool.begin(), v_pool.begin() + a_count );
+  std::sort( a_dst.m_codes.begin(), a_dst.m_codes.end() );
+  int v_cols = a_dst.m_atlas_width / (v_max_w + 1);
+  a_dst.m_atlas_height = ((a_count + v_cols - 1) / v_cols) * (v_max_h + 1);
+  a_dst.m_shades.assign( a_dst.m_atlas_width * a_dst.m_atlas_height, 0 );
+  a_dst.m_symbols.resize( a_count );
+  a_dst.m_data.clear();
+  nibble_writer_s v_writer( a_dst.m_data );
+  static const int v_runs[] = { 1, 1, 1, 2, 3, 5, 9, 17, 40 };
+  for ( int i = 0; i < a_count; ++i ) {
+    packed_symbol_desc_s & s = a_dst.m_symbols[i];
+    int v_x = (i % v_cols) * (v_max_w + 1);
+    int v_y = (i / v_cols) * (v_max_h + 1);
+    s.m_code = a_dst.m_codes[i];
+    s.m_width = 1 + v_rnd() % v_max_w;
+    s.m_height = 1 + v_rnd() % v_max_h;
+    s.m_x_offset = v_rnd() % 6;
+    s.m_y_offset = v_rnd() % 9;
+    s.m_x_advance = s.m_width + s.m_x_offset + v_rnd() % 9;
+    s.m_offset = a_dst.m_data.size() - (v_writer.m_low ? 1 : 0);
+    s.m_nibble = v_writer.m_low ? 1 : 0;
+    a_dst.m_max_symbol_width = std::max( a_dst.m_max_symbol_width, (int)s.m_x_advance );
+    bool v_runs_mode = (v_rnd() % 10) >= 3;
+    // shades
+    for ( int y = 0; y < s.m_height; ++y ) {
+      uint8_t * v_row = &a_dst.m_shades[(v_y + y) * a_dst.m_atlas_width + v_x];
+      for ( int x = 0; x < s.m_width; ) {
+        int v_run = v_runs_mode ? v_runs[v_rnd() % 9] : 1;
+        uint8_t v_shade = (v_rnd() % 10) < 7 ? v_rnd() % 8 : ((v_rnd() & 1) ? 7 : 0);
+        for ( ; v_run > 0 && x < s.m_width; --v_run ) {
+          v_row[x++] = v_shade;
+        }
+      }
+    }
+    // pack
+    int v_color = 0;
+    int v_counter = 0;
+    for ( int y = 0; y < s.m_height; ++y ) {
+      const uint8_t * v_row = &a_dst.m_shades[(v_y + y) * a_dst.m_atlas_width + v_x];
+      for ( int x = 0; x < s.m_width; ++x ) {
+        if ( v_row[x] != v_color ) {
+          if ( v_counter > 0 ) {
+            v_writer.put( (v_counter - 1) | 0x8 );
+            v_counter = 0;
+          }
+          v_color = v_row[x];
+          v_writer.put( v_color );
+        } else if ( ++v_counter >= 8 ) {
+          v_writer.put( 0x0F );
+          v_counter = 0;
+        }
+      }
+    }
+    if ( v_counter > 0 ) {
+      v_writer.put( (v_counter - 1) | 0x8 );
+    }
+  }
+  size_t v_bmp_size = a_dst.m_data.size();
+  // decoder may read one byte ahead
+  a_dst.m_data.push_back( 0 );
+  ::memset( &a_dst.m_font, 0, sizeof(a_dst.m_font) );
+  a_dst.m_font.m_bmp = a_dst.m_data.data();
+  a_dst.m_font.m_symbols_count = a_count;
+  a_dst.m_font.m_row_height = v_max_h + 10;
+  a_dst.m_font.m_def_code_idx = 0;
+  a_dst.m_font.m_symbols = a_dst.m_symbols.data();
+  a_dst.m_font.m_bmp_size = v_bmp_size;
+  // compact symbols table, codes of synthetic font are less than 0x10000
+  int v_pos_bytes = 1;
+  while ( v_pos_bytes < 4 && (v_bmp_size << 1) >= (1ULL << (v_pos_bytes * 8)) ) {
+    ++v_pos_bytes;
+  }
+  a_dst.m_codes16.clear();
+  a_dst.m_metrics.clear();
+  for ( const packed_symbol_desc_s & s: a_dst.m_symbols ) {
+    uint32_t v_pos = (s.m_offset << 1) | s.m_nibble;
+    a_dst.m_codes16.push_back( s.m_code );
+    a_dst.m_metrics.insert( a_dst.m_metrics.end(), { s.m_width, s.m_height, s.m_x_offset, s.m_y_offset, s.m_x_advance } );
+    for ( int i = 0; i < v_pos_bytes; ++i ) {
+      a_dst.m_metrics.push_back( (uint8_t)(v_pos >> (i * 8)) );
+    }
+  }
+  a_dst.m_compact.m_codes16 = a_dst.m_codes16.data();
+  a_dst.m_compact.m_codes32 = 0;
+  a_dst.m_compact.m_metrics = a_dst.m_metrics.data();
+  a_dst.m_compact.m_pos_bytes = v_pos_bytes;
+  a_dst.m_compact_font = a_dst.m_font;
+  a_dst.m_compact_font.m_symbols = 0;
+  a_dst.m_compact_font.m_compact = &a_dst.m_compact;
+}
+
+
+// write synthetic font as BMFont text and targa files, input for font_2_src
+bool write_synth_font_files( const synth_font_s & a_src, const std::string & a_txt, const std::string & a_tga ) {
+  FILE * v_fp = ::fopen( a_txt.c_str(), "wb" );
+  if ( !v_fp ) {
+    return false;
+  }
+  int v_cols = a_src.m_atlas_width / 61;
+  ::fprintf( v_fp, "info face=\"synth\" size=48\n"
+                   "common lineHeight=%d base=40 scaleW=%d scaleH=%d pages=1 packed=0\n"
+                   "page id=0 file=\"%s\"\n"
+                   "chars count=%d\n"
+                 , a_src.m_font.m_row_height, a_src.m_atlas_width, a_src.m_atlas_height
+                 , a_tga.c_str(), (int)a_src.m_symbols.size() );
+  for ( size_t i = 0; i < a_src.m_symbols.size(); ++i ) {
+    const packed_symbol_desc_s & s = a_src.m_symbols[i];
+    ::fprintf( v_fp, "char id=%u x=%d y=%d width=%d height=%d xoffset=%d yoffset=%d xadvance=%d page=0 chnl=15\n"
+                   , s.m_code, (int)(i % v_cols) * 61, (int)(i / v_cols) * 49
+                   , s.m_width, s.m_height, s.m_x_offset, s.m_y_offset, s.m_x_advance );
+  }
+  ::fclose( v_fp );
+  v_fp = ::fopen( a_tga.c_str(), "wb" );
+  if ( !v_fp ) {
+    return false;
+  }
+  // uncompressed truecolor, top left origin
+  uint8_t v_head[18] = { 0, 0, 2 };
+  v_head[12] = a_src.m_atlas_width & 0xFF;
+  v_head[13] = a_src.m_atlas_width >> 8;
+  v_head[14] = a_src.m_atlas_height & 0xFF;
+  v_head[15] = a_src.m_atlas_height >> 8;
+  v_head[16] = 24;
+  v_head[17] = 0x20;
+  ::fwrite( v_head, sizeof(v_head), 1, v_fp );
+  std::vector<uint8_t> v_pixels( a_src.m_shades.size() * 3 );
+  for ( size_t i = 0; i < a_src.m_shades.size(); ++i ) {
+    ::memset( &v_pixels[i * 3], a_src.m_shades[i] * 32 + 16, 3 );
+  }
+  ::fwrite( v_pixels.data(), v_pixels.size(), 1, v_fp );
+  uint8_t v_footer[26] = { 0 };
+  ::fwrite( v_footer, sizeof(v_footer), 1, v_fp );
+  ::fclose( v_fp );
+  return true;
+}
+
+
+// append symbol code as UTF-8
+void append_utf8( std::string & a_dst, uint32_t a_code ) {
+  if ( a_code < 0x80 ) {
+    a_dst.push_back( a_code );
+  } else if ( a_code < 0x800 ) {
+    a_dst.push_back( 0xC0 | (a_code >> 6) );
+    a_dst.push_back( 0x80 | (a_code & 0x3F) );
+  } else if ( a_code < 0x10000 ) {
+    a_dst.push_back( 0xE0 | (a_code >> 12) );
+    a_dst.push_back( 0x80 | ((a_code >> 6) & 0x3F) );
+    a_dst.push_back( 0x80 | (a_code & 0x3F) );
+  } else {
+    a_dst.push_back( 0xF0 | (a_code >> 18) );
+    a_dst.push_back( 0x80 | ((a_code >> 12) & 0x3F) );
+    a_dst.push_back( 0x80 | ((a_code >> 6) & 0x3F) );
+    a_dst.push_back( 0x80 | (a_code & 0x3F) );
+  }
+}
+
+
+// random strings of 8..40 font symbols
+std::vector<std::string> make_texts( const std::vector<uint32_t> & a_codes, int a_count, unsigned a_seed ) {
+  std::mt19937 v_rnd( a_seed );
+  std::vector<std::string> v_result( a_count );
+  for ( auto & v_str: v_result ) {
+    int v_len = 8 + v_rnd() % 33;
+    for ( int i = 0; i < v_len; ++i ) {
+      append_utf8( v_str, a_codes[v_rnd() % a_codes.size()] );
+    }
+  }
+  return v_result;
+}
+
+
+// measured rates of one benchmark
+struct bench_result_s {
+  std::vector<double> m_rates;            // items per second, one per run
+  std::vector<double> m_rates2;           // second metric per second, if any
+};
+
+
+// call a_batch until a_options.m_run_seconds passed, a_runs times,
+// a_batch returns items done and adds second metric into a_items2
+bench_result_s run_bench( const bench_options_s & a_options, const std::function<uint64_t(uint64_t &)> & a_batch ) {
+  bench_result_s v_result;
+  uint64_t v_items2 = 0;
+  // warm up caches and branch predictors
+  a_batch( v_items2 );
+  for ( int r = 0; r < a_options.m_runs; ++r ) {
+    uint64_t v_items = 0;
+    v_items2 = 0;
+    auto v_start = std::chrono::steady_clock::now();
+    double v_seconds = 0;
+    do {
+      v_items += a_batch( v_items2 );
+      v_seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - v_start ).count();
+    } while ( v_seconds < a_options.m_run_seconds );
+    v_result.m_rates.push_back( v_items / v_seconds );
+    v_result.m_rates2.push_back( v_items2 / v_seconds );
+  }
+  return v_result;
+}
+
+
+// one JSON object per line: median, min and max of runs
+void report( const char * a_bench, const char * a_font, const char * a_unit, std::vector<double> a_values ) {
+  std::sort( a_values.begin(), a_values.end() );
+  size_t n = a_values.size();
+  double v_median = (n & 1) ? a_values[n / 2] : (a_values[n / 2 - 1] + a_values[n / 2]) / 2;
+  ::printf( "{\"bench\":\"%s\",\"font\":\"%s\",\"unit\":\"%s\",\"median\":%.6g,\"min\":%.6g,\"max\":%.6g,\"runs\":%d}\n"
+          , a_bench, a_font, a_unit, v_median, a_values.front(), a_values.back(), (int)n );
+  ::fflush( stdout );
+}
+
+
+// decoding of strings into codes, one by one and by batches
+void bench_utf8( const bench_options_s & a_options, const char * a_name, const std::vector<std::string> & a_texts ) {
+  bench_result_s v_utf8 = run_bench( a_options, [&]( uint64_t & a_codes ) -> uint64_t {
+    uint32_t v_sum = 0;
+    for ( const auto & s: a_texts ) {
+      const char * v_ptr = s.c_str();
+      for ( uint32_t c = get_next_utf8_code( &v_ptr ); c; c = get_next_utf8_code( &v_ptr ) ) {
+        v_sum += c;
+        ++a_codes;
+      }
+    }
+    g_sink = v_sum;
+    return a_texts.size();
+  });
+  report( "get_next_utf8_code", a_name, "strings/s", v_utf8.m_rates );
+  report( "get_next_utf8_code", a_name, "codes/s", v_utf8.m_rates2 );
+  bench_result_s v_decode = run_bench( a_options, [&]( uint64_t & a_codes ) -> uint64_t {
+    uint32_t v_sum = 0;
+    uint32_t v_codes[64];
+    for ( const auto & s: a_texts ) {
+      const char * v_ptr = s.data();
+      const char * v_end = v_ptr + s.size();
+      int v_error = UTF8_OK;
+      while ( v_ptr < v_end && UTF8_OK == v_error ) {
+        int v_count = utf8_decode( &v_ptr, v_end, v_codes, 64, &v_error );
+        v_sum += v_count > 0 ? v_codes[v_count - 1] : 0;
+        a_codes += v_count;
+      }
+    }
+    g_sink = v_sum;
+    return a_texts.size();
+  });
+  report( "utf8_decode", a_name, "strings/s", v_decode.m_rates );
+  report( "utf8_decode", a_name, "codes/s", v_decode.m_rates2 );
+}
+
+
+void bench_font( const bench_options_s & a_options, const char * a_name, const packed_font_desc_s * a_font, int a_max_symbol_width ) {
+  std::vector<uint32_t> v_codes;
+  for ( int i = 0; i < a_font->m_symbols_count; ++i ) {
+    if ( !a_font->m_compact ) {
+      v_codes.push_back( a_font->m_symbols[i].m_code );
+    } else if ( a_font->m_compact->m_codes16 ) {
+      v_codes.push_back( a_font->m_compact->m_codes16[i] );
+    } else {
+      v_codes.push_back( a_font->m_compact->m_codes32[i] );
+    }
+  }
+  // decode all symbols
+  std::vector<uint16_t> v_row( a_max_symbol_width + 16 );
+  display_palette_s v_palette;
+  display_palette_init( &v_palette, 0x1234, 0xFEDC );
+  bench_result_s v_decode = run_bench( a_options, [&]( uint64_t & a_pixels ) -> uint64_t {
+    display_char_s v_char;
+    uint32_t v_sum = 0;
+    for ( uint32_t v_code: v_codes ) {
+      display_char_init_pal( &v_char, v_code, a_font, v_row.data(), &v_palette );
+      int v_rows = 0;
+      while ( ++v_rows, !display_char_row( &v_char ) ) {
+      }
+      v_sum += v_row[v_char.m_cols_count - 1];
+      a_pixels += v_rows * v_char.m_cols_count;
+    }
+    g_sink = v_sum;
+    return v_codes.size();
+  });
+  report( "display_char_row", a_name, "glyphs/s", v_decode.m_rates );
+  report( "display_char_row", a_name, "pixels/s", v_decode.m_rates2 );
+  // symbols search, existing codes and misses
+  std::mt19937 v_rnd( a_options.m_seed );
+  std::vector<uint32_t> v_lookup_codes( 4096 );
+  for ( auto & c: v_lookup_codes ) {
+    c = (v_rnd() % 8) ? v_codes[v_rnd() % v_codes.size()] : v_rnd() % 0x10000;
+  }
+  bench_result_s v_lookup = run_bench( a_options, [&]( uint64_t & ) -> uint64_t {
+    uint32_t v_sum = 0;
+    packed_symbol_desc_s v_buf;
+    for ( uint32_t c: v_lookup_codes ) {
+      v_sum += get_symbol_desc_buf( a_font, c, &v_buf )->m_x_advance;
+    }
+    g_sink = v_sum;
+    return v_lookup_codes.size();
+  });
+  report( "get_symbol_desc", a_name, "lookups/s", v_lookup.m_rates );
+  // strings measurement and decoding
+  std::vector<std::string> v_texts = make_texts( v_codes, 1024, a_options.m_seed );
+  bench_result_s v_extent = run_bench( a_options, [&]( uint64_t & ) -> uint64_t {
+    uint32_t v_sum = 0;
+    for ( const auto & s: v_texts ) {
+      int v_width, v_height;
+      get_text_extent( a_font, s.c_str(), &v_width, &v_height );
+      v_sum += v_width + v_height;
+    }
+    g_sink = v_sum;
+    return v_texts.size();
+  });
+  report( "get_text_extent", a_name, "strings/s", v_extent.m_rates );
+  bench_utf8( a_options, a_name, v_texts );
+  // line setup from string and from prepared text
+  const int v_line_width = 4096;
+  std::vector<uint16_t> v_line_row( v_line_width );
+  std::vector<display_char_s> v_chars( v_line_width );
+  bench_result_s v_line = run_bench( a_options, [&]( uint64_t & ) -> uint64_t {
+    uint32_t v_sum = 0;
+    display_line_s v_data;
+    for ( const auto & s: v_texts ) {
+      display_line_init_pal( &v_data, s.c_str(), a_font, v_line_row.data(), v_line_width, v_chars.data(), v_line_width, &v_palette );
+      v_sum += v_data.m_text_width;
+    }
+    g_sink = v_sum;
+    return v_texts.size();
+  });
+  report( "display_line_init", a_name, "lines/s", v_line.m_rates );
+  std::vector<prepared_text_s> v_prepared( v_texts.size() );
+  std::vector<std::vector<prepared_glyph_s> > v_glyphs( v_texts.size() );
+  for ( size_t i = 0; i < v_texts.size(); ++i ) {
+    v_glyphs[i].resize( v_texts[i].size() + 1 );
+    prepared_text_init( &v_prepared[i], a_font, v_texts[i].c_str(), v_glyphs[i].data(), (int)v_glyphs[i].size() );
+  }
+  bench_result_s v_line_prepared = run_bench( a_options, [&]( uint64_t & ) -> uint64_t {
+    uint32_t v_sum = 0;
+    display_line_s v_data;
+    for ( const auto & v_text: v_prepared ) {
+      display_line_init_prepared( &v_data, &v_text, v_line_row.data(), v_line_width, v_chars.data(), v_line_width, &v_palette );
+      v_sum += v_data.m_text_width;
+    }
+    g_sink = v_sum;
+    return v_prepared.size();
+  });
+  report( "display_line_init_prepared", a_name, "lines/s", v_line_prepared.m_rates );
+}
+
+
+// long log lines: ASCII with rare cyrillic and emoji symbols, measured by test32 font
+void bench_log_lines( const bench_options_s & a_options ) {
+  std::mt19937 v_rnd( a_options.m_seed );
+  std::vector<std::string> v_lines( 256 );
+  for ( auto & v_str: v_lines ) {
+    int v_len = 120 + v_rnd() % 280;
+    while ( (int)v_str.size() < v_len ) {
+      int k = v_rnd() % 100;
+      append_utf8( v_str, k < 2 ? 0x1F600 + v_rnd() % 80 : (k < 5 ? 0x430 + v_rnd() % 32 : 32 + v_rnd() % 95) );
+    }
+  }
+  bench_result_s v_extent = run_bench( a_options, [&]( uint64_t & ) -> uint64_t {
+    uint32_t v_sum = 0;
+    for ( const auto & s: v_lines ) {
+      int v_width, v_height;
+      get_text_extent( &test32_font, s.c_str(), &v_width, &v_height );
+      v_sum += v_width + v_height;
+    }
+    g_sink = v_sum;
+    return v_lines.size();
+  });
+  report( "get_text_extent", "log", "strings/s", v_extent.m_rates );
+  bench_utf8( a_options, "log", v_lines );
+}
+
+
+// sink which drops pixels, for rendering time alone
+static void null_sink_begin( void *, int, int, int, int ) {
+}
+
+
+static void null_sink_push( void *, const uint16_t * a_pixels, int a_count ) {
+  g_sink = a_pixels[a_count - 1];
+}
+
+
+// window of text lines streamed to simulated SPI panel: rendering alone, then with bus of the same
+// throughput through one band buffer (render and transfer one after other) and two band buffers (overlapped),
+// frames/s by simulated time
+void bench_stream( const bench_options_s & a_options ) {
+  const int v_width = 480;
+  const int v_band_size = v_width * 8;
+  const packed_font_desc_s * v_font = &test32_font;
+  int v_lines_count = 320 / v_font->m_row_height;
+  int v_height = v_lines_count * v_font->m_row_height;
+  std::mt19937 v_rnd( a_options.m_seed );
+  std::vector<std::string> v_lines( v_lines_count );
+  for ( auto & v_str: v_lines ) {
+    for ( int i = 0; i < 40; ++i ) {
+      append_utf8( v_str, 32 + v_rnd() % 95 );
+    }
+  }
+  display_palette_s v_palette;
+  display_palette_init( &v_palette, 0x0000, 0xFFFF );
+  std::vector<uint16_t> v_buffers( 2 * v_band_size );
+  std::vector<display_char_s> v_chars( 64 );
+  auto v_frame = [&]( const stream_sink_s * a_sink, bool a_two_buffers ) {
+    stream_s v_stream;
+    stream_init( &v_stream, a_sink, v_buffers.data(), a_two_buffers ? v_buffers.data() + v_band_size : 0, v_band_size );
+    stream_begin( &v_stream, 0, 0, v_width, v_height );
+    for ( const auto & v_str: v_lines ) {
+      display_line_s v_line;
+      display_line_init_pal( &v_line, v_str.c_str(), v_font, v_buffers.data(), v_width, v_chars.data(), (int)v_chars.size(), &v_palette );
+      stream_line( &v_stream, &v_line );
+    }
+    stream_end( &v_stream );
+  };
+  stream_sink_s v_null_sink = { 0, null_sink_begin, null_sink_push, 0, 0 };
+  bench_result_s v_render = run_bench( a_options, [&]( uint64_t & ) -> uint64_t {
+    v_frame( &v_null_sink, true );
+    return 1;
+  });
+  report( "stream_render", "test32", "frames/s", v_render.m_rates );
+  // bus as fast as rendering, sum of times is twice max of them
+  std::vector<double> v_sorted = v_render.m_rates;
+  std::sort( v_sorted.begin(), v_sorted.end() );
+  double v_bits_per_second = 16.0 * v_width * v_height * v_sorted[v_sorted.size() / 2];
+  for ( int v_two_buffers = 0; v_two_buffers < 2; ++v_two_buffers ) {
+    spi_sim_s * v_sim = spi_sim_create( v_bits_per_second, 0, v_width, v_height, v_two_buffers );
+    std::vector<double> v_rates;
+    v_frame( spi_sim_sink( v_sim ), v_two_buffers );
+    for ( int r = 0; r < a_options.m_runs; ++r ) {
+      spi_sim_stats_s v_stats;
+      spi_sim_get_stats( v_sim, &v_stats, true );
+      uint64_t v_frames = 0;
+      do {
+        v_frame( spi_sim_sink( v_sim ), v_two_buffers );
+        ++v_frames;
+        spi_sim_get_stats( v_sim, &v_stats, false );
+      } while ( v_stats.m_seconds < a_options.m_run_seconds );
+      v_rates.push_back( v_frames / v_stats.m_seconds );
+    }
+    spi_sim_destroy( v_sim );
+    report( v_two_buffers ? "stream_two_buffers" : "stream_one_buffer", "test32", "frames/s", v_rates );
+  }
+}
+
+
+// compare display_char_row_fast and display_line_row_fast with display_char_row and display_line_row on every
+// row of every symbol and on random lines, for each implementation supported by processor,
+// prints and returns mismatches count
+int check_fast_rows( const bench_options_s & a_options, const char * a_name, const packed_font_desc_s * a_font, const std::vector<uint32_t> & a_codes ) {
+  // room for symbol pixels beyond x_advance, untouched pixels are compared too
+  const int v_row_size = 512 + 16;
+  const uint16_t v_mark = 0x5A5A;
+  display_palette_s v_palette;
+  display_palette_init( &v_palette, 0x1234, 0xFEDC );
+  std::vector<std::string> v_texts = make_texts( a_codes, 256, a_options.m_seed );
+  int v_total = 0;
+  int v_supported = font_bmp_simd_set_level( -1 );
+  for ( int v_level = SIMD_LEVEL_SCALAR; v_level <= v_supported; ++v_level ) {
+    font_bmp_simd_set_level( v_level );
+    int v_mismatches = 0;
+    std::vector<uint16_t> v_ref( v_row_size );
+    std::vector<uint16_t> v_fast( v_row_size );
+    for ( uint32_t v_code: a_codes ) {
+      display_char_s v_ref_char;
+      display_char_s v_fast_char;
+      display_char_init_pal( &v_ref_char, v_code, a_font, v_ref.data(), &v_palette );
+      display_char_init_pal( &v_fast_char, v_code, a_font, v_fast.data(), &v_palette );
+      bool v_last = false;
+      while ( !v_last ) {
+        std::fill( v_ref.begin(), v_ref.end(), v_mark );
+        std::fill( v_fast.begin(), v_fast.end(), v_mark );
+        v_last = display_char_row( &v_ref_char );
+        display_char_row_fast( &v_fast_char );
+        v_mismatches += v_ref != v_fast ? 1 : 0;
+      }
+    }
+    // lines as wide as text, last symbol may be clipped
+    std::vector<display_char_s> v_ref_chars( 64 );
+    std::vector<display_char_s> v_fast_chars( 64 );
+    for ( const auto & v_str: v_texts ) {
+      int v_width, v_height;
+      get_text_extent( a_font, v_str.c_str(), &v_width, &v_height );
+      std::vector<uint16_t> v_ref_line( v_width + 16, v_mark );
+      std::vector<uint16_t> v_fast_line( v_width + 16, v_mark );
+      display_line_s v_ref_data;
+      display_line_s v_fast_data;
+      display_line_init_pal( &v_ref_data, v_str.c_str(), a_font, v_ref_line.data(), v_width, v_ref_chars.data(), 64, &v_palette );
+      display_line_init_pal( &v_fast_data, v_str.c_str(), a_font, v_fast_line.data(), v_width, v_fast_chars.data(), 64, &v_palette );
+      bool v_last = false;
+      while ( !v_last ) {
+        v_last = display_line_row( &v_ref_data );
+        display_line_row_fast( &v_fast_data );
+        v_mismatches += v_ref_line != v_fast_line ? 1 : 0;
+      }
+    }
+    ::printf( "{\"check\":\"display_char_row_fast\",\"font\":\"%s\",\"level\":%d,\"mismatches\":%d}\n", a_name, v_level, v_mismatches );
+    ::fflush( stdout );
+    v_total += v_mismatches;
+  }
+  font_bmp_simd_set_level( -1 );
+  return v_total;
+}
+
+
+// check fast rows on test32, synthetic fonts and, with converter, on huffman coded synthetic font
+int check_fonts( const bench_options_s & a_options, const synth_font_s & a_synth ) {
+  std::vector<uint32_t> v_codes;
+  for ( int i = 0; i < test32_font.m_symbols_count; ++i ) {
+    v_codes.push_back( test32_font.m_symbols[i].m_code );
+  }
+  int v_result = check_fast_rows( a_options, "test32", &test32_font, v_codes );
+  v_result += check_fast_rows( a_options, "synth", &a_synth.m_font, a_synth.m_codes );
+  v_result += check_fast_rows( a_options, "synth_compact", &a_synth.m_compact_font, a_synth.m_codes );
+  if ( !a_options.m_converter ) {
+    return v_result;
+  }
+  std::string v_base = std::string( a_options.m_work_dir ) + "/bench_synth";
+  if ( !write_synth_font_files( a_synth, v_base + ".txt", v_base + ".tga" ) ) {
+    ::fprintf( stderr, "can't write synthetic font files '%s.*'\n", v_base.c_str() );
+    return v_result + 1;
+  }
+  std::string v_cmd = std::string( a_options.m_converter ) + " -H -b " + v_base + "_huffman.bin "
+                    + v_base + ".txt " + v_base + ".h " + v_base + ".c > /dev/null";
+  font_file_s v_file;
+  if ( 0 != ::system( v_cmd.c_str() ) || !font_file_open( &v_file, (v_base + "_huffman.bin").c_str() ) ) {
+    ::fprintf( stderr, "command '%s' failed\n", v_cmd.c_str() );
+    return v_result + 1;
+  }
+  if ( !v_file.m_font.m_huffman ) {
+    ::fprintf( stderr, "synthetic font isn't huffman coded, check skipped\n" );
+  } else {
+    v_result += check_fast_rows( a_options, "synth_huffman", &v_file.m_font, a_synth.m_codes );
+  }
+  font_file_close( &v_file );
+  return v_result;
+}
+
+
+// time font_2_src on synthetic font files, whole process wall time
+void bench_converter( const bench_options_s & a_options, const synth_font_s & a_font ) {
+  std::string v_base = std::string( a_options.m_work_dir ) + "/bench_synth";
+  std::string v_txt = v_base + ".txt";
+  std::string v_tga = v_base + ".tga";
+  if ( !write_synth_font_files( a_font, v_txt, v_tga ) ) {
+    ::fprintf( stderr, "can't write synthetic font files '%s.*'\n", v_base.c_str() );
+    return;
+  }
+  std::string v_cmd = std::string( a_options.m_converter ) + " "
+                    + v_txt + " " + v_base + ".h " + v_base + ".c > /dev/null";
+  std::vector<double> v_seconds;
+  for ( int r = 0; r < a_options.m_runs; ++r ) {
+    auto v_start = std::chrono::steady_clock::now();
+    int v_rc = ::system( v_cmd.c_str() );
+    double v_time = std::chrono::duration<double>( std::chrono::steady_clock::now() - v_start ).count();
+    if ( 0 != v_rc ) {
+      ::fprintf( stderr, "command '%s' failed\n", v_cmd.c_str() );
+      return;
+    }
+    v_seconds.push_back( v_time );
+  }
+  report( "font_2_src", "synth", "s", v_seconds );
+}
+
+
+int main( int argc, char ** argv ) {
+  bench_options_s v_options;
+  int v_opt;
+  while ( -1 != (v_opt = ::getopt( argc, argv, "n:t:g:s:c:w:v" )) ) {
+    switch ( v_opt ) {
+      case 'n':
+        v_options.m_runs = std::max( 1, ::atoi( optarg ) );
+        break;
+      case 't':
+        v_options.m_run_seconds = ::atof( optarg );
+        break;
+      case 'g':
+        v_options.m_glyphs = std::max( 1, ::atoi( optarg ) );
+        break;
+      case 's':
+        v_options.m_seed = ::atoi( optarg );
+        break;
+      case 'c':
+        v_options.m_converter = optarg;
+        break;
+      case 'w':
+        v_options.m_work_dir = optarg;
+        break;
+      case 'v':
+        v_options.m_check = true;
+        break;
+      default:
+        ::fprintf( stderr, "options:\n"
+                           "  -n runs     measured runs of each benchmark (%d)\n"
+                           "  -t seconds  minimal duration of one run (%g)\n"
+                           "  -g count    synthetic font symbols count (%d)\n"
+                           "  -s seed     synthetic font and texts seed (%u)\n"
+                           "  -c path     font_2_src to time on synthetic font\n"
+                           "  -w dir      directory for synthetic font files (%s)\n"
+                           "  -v          check fast rows on all implementations instead of benchmarks\n"
+                         , v_options.m_runs, v_options.m_run_seconds, v_options.m_glyphs
+                         , v_options.m_seed, v_options.m_work_dir );
+        return 1;
+    }
+  }
+  synth_font_s v_synth;
+  make_synth_font( v_synth, v_options.m_glyphs, v_options.m_seed );
+  if ( v_options.m_check ) {
+    return 0 == check_fonts( v_options, v_synth ) ? 0 : 1;
+  }
+  bench_font( v_options, "test32", &test32_font, test32_font_MAX_SYMBOL_WIDTH );
+  bench_font( v_options, "synth", &v_synth.m_font, v_synth.m_max_symbol_width );
+  bench_font( v_options, "synth_compact", &v_synth.m_compact_font, v_synth.m_max_symbol_width );
+  bench_log_lines( v_options );
+  bench_stream( v_options );
+  if ( v_options.m_converter ) {
+    bench_converter( v_options, v_synth );
+  }
+  return 0;
+}
@@ -4,7 +4,7 @@
 extern "C" {
 #endif
 
-static const uint8_t test32_data[2457] = {
+static const uint8_t test32_data[2382] = {
   0x87, 0x90, 0x79, 0x07, 0x90, 0x79, 0x07, 0x90, 0x78, 0x60, 0x78, 0x60, 0x78, 0x60, 0x78, 0x60
 , 0x67, 0x60, 0x67, 0x50, 0x67, 0x50, 0x67, 0x50, 0x67, 0x50, 0x57, 0x50, 0x34, 0x20, 0xFB, 0x79
 , 0x07, 0x90, 0x79, 0x92, 0x67, 0x86, 0x30, 0xF8, 0x17, 0x82, 0x0C, 0x37, 0x84, 0x87, 0x85, 0x0F
@@ -121,44 +121,39 @@ static const uint8_t test32_data[2457] = {
 , 0xD7, 0x86, 0x06, 0x78, 0x0B, 0x16, 0x78, 0x10, 0x67, 0xF4, 0x09, 0x67, 0xF8, 0x40, 0x86, 0x78
 , 0x0B, 0x14, 0x78, 0x60, 0x67, 0x80, 0xD5, 0x78, 0x26, 0x78, 0x0D, 0x37, 0x84, 0x67, 0x80, 0xD3
 , 0x78, 0x46, 0x78, 0x0D, 0x57, 0x82, 0x67, 0x80, 0xB1, 0x47, 0x90, 0x67, 0xF8, 0x61, 0x06, 0x7E
-, 0x53, 0x09, 0xB2, 0x57, 0x96, 0x52, 0x0D, 0x67, 0xE5, 0x0B, 0x67, 0x85, 0x10, 0x82, 0x57, 0x85
-, 0x09, 0x47, 0x84, 0x0C, 0x57, 0x82, 0x08, 0x78, 0x60, 0xE7, 0x86, 0x02, 0x78, 0x40, 0xE6, 0x78
-, 0x04, 0x78, 0x31, 0xE5, 0x78, 0x14, 0x7F, 0xC2, 0x57, 0xFC, 0x24, 0x78, 0x20, 0xFA, 0x37, 0x83
-, 0x0F, 0xA2, 0x78, 0x50, 0xFB, 0x79, 0x0E, 0x32, 0x09, 0x47, 0x85, 0x0C, 0x27, 0x85, 0x09, 0x67
-, 0x86, 0x21, 0x82, 0x47, 0x90, 0xB6, 0x7F, 0x10, 0xC2, 0x57, 0x96, 0x52, 0x0A, 0x67, 0x80, 0xD5
-, 0x78, 0x56, 0x78, 0x0C, 0x27, 0x95, 0x67, 0x80, 0xC6, 0x79, 0x56, 0x78, 0x0B, 0x37, 0xA5, 0x67
-, 0x80, 0xB7, 0x83, 0x78, 0x56, 0x78, 0x0A, 0x47, 0x60, 0x78, 0x56, 0x78, 0x09, 0x17, 0x82, 0x07
-, 0x85, 0x67, 0x80, 0x95, 0x75, 0x08, 0x78, 0x56, 0x78, 0x08, 0x27, 0x81, 0x08, 0x78, 0x56, 0x78
-, 0x08, 0x67, 0x40, 0x97, 0x85, 0x67, 0x80, 0x37, 0x80, 0xA7, 0x85, 0x67, 0x60, 0x78, 0x30, 0xA7
-, 0x85, 0x67, 0x64, 0x76, 0x0B, 0x78, 0x56, 0x7A, 0x10, 0xB7, 0x85, 0x67, 0x95, 0x0C, 0x78, 0x56
-, 0x79, 0x0D, 0x78, 0x56, 0x78, 0x40, 0xD7, 0x85, 0x78, 0x60, 0x83, 0x67, 0x95, 0x10, 0x96, 0x78
-, 0x06, 0x7D, 0x30, 0x86, 0x78, 0x57, 0x42, 0x12, 0x57, 0x91, 0x06, 0x79, 0x20, 0xB4, 0x78, 0x50
-, 0x67, 0x85, 0x0D, 0x79, 0x06, 0x78, 0x20, 0xD6, 0x78, 0x16, 0x78, 0x10, 0xD4, 0x78, 0x26, 0x78
-, 0x0E, 0x47, 0x83, 0x67, 0x80, 0xE4, 0x78, 0x36, 0x78, 0x0E, 0x47, 0x83, 0x67, 0x80, 0xE4, 0x78
-, 0x26, 0x78, 0x20, 0xD6, 0x78, 0x16, 0x78, 0x40, 0xD7, 0x90, 0x67, 0x91, 0x0B, 0x47, 0x84, 0x06
-, 0x78, 0x67, 0x31, 0x01, 0x47, 0x91, 0x06, 0x78, 0x16, 0x7D, 0x20, 0x86, 0x78, 0x08, 0x36, 0x79
-, 0x41, 0x09, 0x67, 0x80, 0xFA, 0x67, 0x80, 0xFA, 0x67, 0x80, 0xFA, 0x67, 0x80, 0xFA, 0x67, 0x80
-, 0xFA, 0x67, 0x80, 0xFA, 0x67, 0x80, 0xFA, 0x37, 0xFB, 0x03, 0x7F, 0xB0, 0xD7, 0x85, 0x0F, 0xA7
-, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85
-, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F
-, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0C, 0xFF, 0xFF, 0xFC, 0x78, 0x20, 0xFF, 0x84
-, 0x50, 0xB1, 0x78, 0x10, 0xFF, 0x87, 0x93, 0x09, 0x37, 0x80, 0xF9, 0x57, 0xC0, 0x16, 0x78, 0x50
-, 0x86, 0x74, 0x0F, 0x95, 0x7C, 0x09, 0x37, 0x82, 0x07, 0xFB, 0x45, 0x73, 0x18, 0x78, 0x0A, 0x24
-, 0x03, 0x7F, 0xB4, 0x57, 0x10, 0x87, 0x80, 0xD7, 0x84, 0x1F, 0x90, 0x57, 0x10, 0x87, 0x80, 0xC3
-, 0x78, 0x0F, 0xB5, 0x71, 0x08, 0x78, 0x0C, 0x78, 0x40, 0xFB, 0x57, 0x10, 0x87, 0x80, 0x30, 0x94
-, 0x78, 0x17, 0xF9, 0x30, 0x57, 0x10, 0x87, 0x84, 0x78, 0x30, 0x17, 0x21, 0x7F, 0x93, 0x05, 0x71
-, 0x08, 0x78, 0x16, 0x78, 0x61, 0x08, 0x27, 0x60, 0x28, 0x0A, 0x57, 0x20, 0x57, 0x10, 0x87, 0x80
-, 0x83, 0x78, 0x60, 0x83, 0x75, 0x07, 0x84, 0x09, 0x67, 0x20, 0x57, 0x10, 0x87, 0x80, 0x91, 0x61
-, 0x08, 0x47, 0x40, 0x86, 0x75, 0x08, 0x67, 0x20, 0x57, 0x10, 0x87, 0x80, 0xE5, 0x73, 0x09, 0x57
-, 0x40, 0x67, 0x10, 0x57, 0x10, 0x87, 0x80, 0xE6, 0x71, 0x0A, 0x51, 0x07, 0x81, 0x05, 0x71, 0x08
-, 0x78, 0x0B, 0x47, 0xFD, 0x58, 0x71, 0x08, 0x78, 0x0B, 0x47, 0xFD, 0x58, 0x71, 0x08, 0x78, 0x09
-, 0x51, 0x08, 0x27, 0x60, 0x14, 0x10, 0x91, 0x78, 0x10, 0x57, 0xC0, 0x81, 0x78, 0x08, 0x37, 0x50
-, 0x47, 0x50, 0x91, 0x78, 0x08, 0x57, 0xC0, 0x84, 0x75, 0x08, 0x47, 0x40, 0x84, 0x78, 0x10, 0x17
-, 0x80, 0x85, 0x73, 0x1A, 0x08, 0x78, 0x30, 0x85, 0x72, 0x09, 0x37, 0x80, 0x27, 0x60, 0x85, 0x71
-, 0x0B, 0x27, 0x80, 0x97, 0x81, 0x0A, 0x32, 0x03, 0x75, 0x08, 0x57, 0x10, 0xB4, 0x75, 0x09, 0x7F
-, 0xC1, 0x01, 0x0C, 0x78, 0x30, 0x82, 0x7F, 0xC1, 0x0D, 0x27, 0x80, 0xFC, 0x67, 0x20, 0xF5, 0x75
-, 0x0F, 0xC7, 0x81, 0x0E, 0x17, 0x82, 0x0F, 0x10, 0x94, 0x78, 0x0F, 0x47, 0x80, 0xF8, 0x7C, 0x40
-, 0xF8, 0x48, 0x0F, 0x85, 0x79, 0x63, 0x0F, 0xFF, 0xF0
+, 0x53, 0x09, 0x67, 0x80, 0xD5, 0x78, 0x56, 0x78, 0x0C, 0x27, 0x95, 0x67, 0x80, 0xC6, 0x79, 0x56
+, 0x78, 0x0B, 0x37, 0xA5, 0x67, 0x80, 0xB7, 0x83, 0x78, 0x56, 0x78, 0x0A, 0x47, 0x60, 0x78, 0x56
+, 0x78, 0x09, 0x17, 0x82, 0x07, 0x85, 0x67, 0x80, 0x95, 0x75, 0x08, 0x78, 0x56, 0x78, 0x08, 0x27
+, 0x81, 0x08, 0x78, 0x56, 0x78, 0x08, 0x67, 0x40, 0x97, 0x85, 0x67, 0x80, 0x37, 0x80, 0xA7, 0x85
+, 0x67, 0x60, 0x78, 0x30, 0xA7, 0x85, 0x67, 0x64, 0x76, 0x0B, 0x78, 0x56, 0x7A, 0x10, 0xB7, 0x85
+, 0x67, 0x95, 0x0C, 0x78, 0x56, 0x79, 0x0D, 0x78, 0x56, 0x78, 0x40, 0xD7, 0x85, 0x78, 0x60, 0x83
+, 0x67, 0x95, 0x10, 0x96, 0x78, 0x06, 0x7D, 0x30, 0x86, 0x78, 0x57, 0x42, 0x12, 0x57, 0x91, 0x06
+, 0x79, 0x20, 0xB4, 0x78, 0x50, 0x67, 0x85, 0x0D, 0x79, 0x06, 0x78, 0x20, 0xD6, 0x78, 0x16, 0x78
+, 0x10, 0xD4, 0x78, 0x26, 0x78, 0x0E, 0x47, 0x83, 0x67, 0x80, 0xE4, 0x78, 0x36, 0x78, 0x0E, 0x47
+, 0x83, 0x67, 0x80, 0xE4, 0x78, 0x26, 0x78, 0x20, 0xD6, 0x78, 0x16, 0x78, 0x40, 0xD7, 0x90, 0x67
+, 0x91, 0x0B, 0x47, 0x84, 0x06, 0x78, 0x67, 0x31, 0x01, 0x47, 0x91, 0x06, 0x78, 0x16, 0x7D, 0x20
+, 0x86, 0x78, 0x08, 0x36, 0x79, 0x41, 0x09, 0x67, 0x80, 0xFA, 0x67, 0x80, 0xFA, 0x67, 0x80, 0xFA
+, 0x67, 0x80, 0xFA, 0x67, 0x80, 0xFA, 0x67, 0x80, 0xFA, 0x67, 0x80, 0xFA, 0x37, 0xFB, 0x03, 0x7F
+, 0xB0, 0xD7, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F
+, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7
+, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0F, 0xA7, 0x85, 0x0C, 0xFF, 0xFF
+, 0xFC, 0x78, 0x20, 0xFF, 0x84, 0x50, 0xB1, 0x78, 0x10, 0xFF, 0x87, 0x93, 0x09, 0x37, 0x80, 0xF9
+, 0x57, 0xC0, 0x16, 0x78, 0x50, 0x86, 0x74, 0x0F, 0x95, 0x7C, 0x09, 0x37, 0x82, 0x07, 0xFB, 0x45
+, 0x73, 0x18, 0x78, 0x0A, 0x24, 0x03, 0x7F, 0xB4, 0x57, 0x10, 0x87, 0x80, 0xD7, 0x84, 0x1F, 0x90
+, 0x57, 0x10, 0x87, 0x80, 0xC3, 0x78, 0x0F, 0xB5, 0x71, 0x08, 0x78, 0x0C, 0x78, 0x40, 0xFB, 0x57
+, 0x10, 0x87, 0x80, 0x30, 0x94, 0x78, 0x17, 0xF9, 0x30, 0x57, 0x10, 0x87, 0x84, 0x78, 0x30, 0x17
+, 0x21, 0x7F, 0x93, 0x05, 0x71, 0x08, 0x78, 0x16, 0x78, 0x61, 0x08, 0x27, 0x60, 0x28, 0x0A, 0x57
+, 0x20, 0x57, 0x10, 0x87, 0x80, 0x83, 0x78, 0x60, 0x83, 0x75, 0x07, 0x84, 0x09, 0x67, 0x20, 0x57
+, 0x10, 0x87, 0x80, 0x91, 0x61, 0x08, 0x47, 0x40, 0x86, 0x75, 0x08, 0x67, 0x20, 0x57, 0x10, 0x87
+, 0x80, 0xE5, 0x73, 0x09, 0x57, 0x40, 0x67, 0x10, 0x57, 0x10, 0x87, 0x80, 0xE6, 0x71, 0x0A, 0x51
+, 0x07, 0x81, 0x05, 0x71, 0x08, 0x78, 0x0B, 0x47, 0xFD, 0x58, 0x71, 0x08, 0x78, 0x0B, 0x47, 0xFD
+, 0x58, 0x71, 0x08, 0x78, 0x09, 0x51, 0x08, 0x27, 0x60, 0x14, 0x10, 0x91, 0x78, 0x10, 0x57, 0xC0
+, 0x81, 0x78, 0x08, 0x37, 0x50, 0x47, 0x50, 0x91, 0x78, 0x08, 0x57, 0xC0, 0x84, 0x75, 0x08, 0x47
+, 0x40, 0x84, 0x78, 0x10, 0x17, 0x80, 0x85, 0x73, 0x1A, 0x08, 0x78, 0x30, 0x85, 0x72, 0x09, 0x37
+, 0x80, 0x27, 0x60, 0x85, 0x71, 0x0B, 0x27, 0x80, 0x97, 0x81, 0x0A, 0x32, 0x03, 0x75, 0x08, 0x57
+, 0x10, 0xB4, 0x75, 0x09, 0x7F, 0xC1, 0x01, 0x0C, 0x78, 0x30, 0x82, 0x7F, 0xC1, 0x0D, 0x27, 0x80
+, 0xFC, 0x67, 0x20, 0xF5, 0x75, 0x0F, 0xC7, 0x81, 0x0E, 0x17, 0x82, 0x0F, 0x10, 0x94, 0x78, 0x0F
+, 0x47, 0x80, 0xF8, 0x7C, 0x40, 0xF8, 0x48, 0x0F, 0x85, 0x79, 0x63, 0x0F, 0xFF, 0xF0
 };
 
 static const packed_symbol_desc_s test32_symdesc[29] = {
@@ -186,15 +181,15 @@ static const packed_symbol_desc_s test32_symdesc[29] = {
 , {161, 1632, 0, 4, 22, 3, 8, 11}
 , {1055, 1669, 0, 19, 22, 2, 3, 23}
 , {1074, 1784, 0, 14, 17, 2, 8, 17}
-, {1077, 1858, 0, 16, 17, 1, 8, 18}
-, {1080, 1933, 0, 14, 17, 2, 8, 18}
-, {1088, 2024, 0, 15, 24, 2, 8, 18}
-, {1090, 2135, 0, 15, 17, 0, 8, 15}
-, {21992, 2185, 0, 29, 32, 2, 0, 33}
+, {1077, 1437, 1, 16, 17, 1, 8, 18}
+, {1080, 1858, 0, 14, 17, 2, 8, 18}
+, {1088, 1949, 0, 15, 24, 2, 8, 18}
+, {1090, 2060, 0, 15, 17, 0, 8, 15}
+, {21992, 2110, 0, 29, 32, 2, 0, 33}
 };
 
 const packed_font_desc_s test32_font = {
-test32_data, 29, 32, 0, test32_symdesc
+test32_data, 29, 32, 0, test32_symdesc, 0, 0, 0, 0, 0, 2382, 0, 0
 };
 
 #ifdef __cplusplus